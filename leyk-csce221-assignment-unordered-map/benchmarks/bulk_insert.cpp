@@ -0,0 +1,107 @@
+#include "UnorderedMap.h"
+#include "hash_functions.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+    Building an UnorderedMap one insert at a time against the bulk range
+    insert. The workload is src/main.cpp's, scaled from 10k to 10M elements:
+    "Adjective Animal" keys drawn from data_files, hashed with FNV-1a, so
+    about a tenth of the keys are distinct and the rest are duplicates.
+    Every map runs at a maximum load factor of 1.0. After each build, every
+    key is looked up once in input order.
+
+    Run from this directory so ../data_files is found.
+*/
+
+constexpr size_t N_ELEMENTS = 10'000'000;
+
+using Map = UnorderedMap<std::string, int, fnv1a_hash>;
+using value_type = std::pair<std::string, int>;
+
+std::vector<std::string> read_lines(std::filesystem::path const & path) {
+    std::ifstream file(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while(std::getline(file, line))
+        lines.push_back(line);
+    return lines;
+}
+
+template<typename Build>
+void bench(std::string const & name, std::vector<value_type> const & pairs, Build build) {
+    auto start = std::chrono::steady_clock::now();
+    Map map = build();
+    auto built = std::chrono::steady_clock::now();
+
+    size_t checksum = 0;
+    for(auto const & pair : pairs)
+        checksum += map.find(pair.first)->second;
+    auto stop = std::chrono::steady_clock::now();
+
+    double build_seconds = std::chrono::duration<double>(built - start).count();
+    double find_seconds = std::chrono::duration<double>(stop - built).count();
+    std::cout << std::setw(22) << name << ": "
+              << std::fixed << std::setprecision(2) << build_seconds << " s build, "
+              << find_seconds << " s finds"
+              << "  (size: " << map.size() << ", buckets: " << map.bucket_count()
+              << ", checksum: " << checksum << ")" << std::endl;
+}
+
+int main() {
+    std::filesystem::path data_files = std::filesystem::path("..") / "data_files";
+    std::vector<std::string> adjectives = read_lines(data_files / "adjectives.txt");
+    std::vector<std::string> animals = read_lines(data_files / "animals.txt");
+    if(adjectives.empty() || animals.empty()) {
+        std::cerr << "Could not read " << data_files << std::endl;
+        return 1;
+    }
+
+    std::mt19937 generator(221);
+    std::uniform_int_distribution<size_t> adjective(0, adjectives.size() - 1);
+    std::uniform_int_distribution<size_t> animal(0, animals.size() - 1);
+
+    std::vector<value_type> pairs(N_ELEMENTS);
+    for(size_t i = 0; i < N_ELEMENTS; i++) {
+        std::string key = adjectives[adjective(generator)] + " " + animals[animal(generator)];
+        key[0] = std::toupper(key[0]);
+        pairs[i] = {key, static_cast<int>(i)};
+    }
+
+    std::cout << "Building from " << N_ELEMENTS << " pairs:" << std::endl;
+
+    bench("insert, growing", pairs, [&] {
+        Map map(0);
+        map.max_load_factor(1.0f);
+        for(auto const & pair : pairs)
+            map.insert(pair);
+        return map;
+    });
+
+    bench("insert, reserved", pairs, [&] {
+        Map map(0);
+        map.max_load_factor(1.0f);
+        map.reserve(pairs.size());
+        for(auto const & pair : pairs)
+            map.insert(pair);
+        return map;
+    });
+
+    bench("insert(first, last)", pairs, [&] {
+        Map map(0);
+        map.max_load_factor(1.0f);
+        map.insert(pairs.begin(), pairs.end());
+        return map;
+    });
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "ConcurrentUnorderedMap.h"
+#include "UnorderedMap.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    Throughput of ConcurrentUnorderedMap against one UnorderedMap behind one
+    mutex, from 1 to 64 threads. Both start with half of KEY_SPACE inserted
+    and run N_OPERATIONS random operations in total, split evenly over the
+    threads: 90% finds, 5% inserts and 5% erases on keys drawn uniformly
+    from KEY_SPACE. Keys are scrambled by an odd multiplier, as sequential
+    integers under the identity std::hash would lay one big map out in key
+    order and flatter it. Threads beyond the machine's core count only add
+    contention, so scaling flattens there.
+*/
+
+constexpr size_t KEY_SPACE = 1 << 20;
+constexpr size_t N_OPERATIONS = 1 << 23;
+constexpr size_t MAX_THREADS = 64;
+
+size_t scramble(size_t index) {
+    return index * 0x9E3779B97F4A7C15ull;
+}
+
+// The single mutex baseline, with the same interface the benchmark uses
+class LockedMap {
+    mutable std::mutex _mutex;
+    UnorderedMap<size_t, size_t> _map;
+
+public:
+    LockedMap() : _map(0) {
+        _map.max_load_factor(1.0f);
+    }
+
+    bool insert(std::pair<const size_t, size_t> const & value) {
+        std::lock_guard lock(_mutex);
+        return _map.insert(value).second;
+    }
+
+    bool contains(size_t key) const {
+        std::lock_guard lock(_mutex);
+        return _map.contains(key);
+    }
+
+    size_t erase(size_t key) {
+        std::lock_guard lock(_mutex);
+        return _map.erase(key);
+    }
+};
+
+template<typename Map>
+double run(Map & map, size_t n_threads) {
+    for(size_t index = 0; index < KEY_SPACE; index += 2)
+        map.insert({scramble(index), index});
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for(size_t thread = 0; thread < n_threads; thread++) {
+        threads.emplace_back([&map, n_threads, thread] {
+            std::mt19937_64 generator(221 + thread);
+            size_t hits = 0;
+            for(size_t i = 0; i < N_OPERATIONS / n_threads; i++) {
+                size_t random = generator();
+                size_t key = scramble(random % KEY_SPACE);
+                size_t operation = (random >> 32) % 100;
+                if(operation < 90)
+                    hits += map.contains(key);
+                else if(operation < 95)
+                    map.insert({key, key});
+                else
+                    map.erase(key);
+            }
+            if(hits == ~size_t{0})
+                std::cout << hits;
+        });
+    }
+    for(auto & thread : threads)
+        thread.join();
+    auto stop = std::chrono::steady_clock::now();
+
+    return N_OPERATIONS / std::chrono::duration<double>(stop - start).count() / 1e6;
+}
+
+int main() {
+    std::cout << "Mixed operations (90% find, 5% insert, 5% erase), " << N_OPERATIONS << " in total, "
+              << std::thread::hardware_concurrency() << " hardware threads:" << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "one mutex" << std::setw(16) << "sharded" << std::endl;
+
+    for(size_t n_threads = 1; n_threads <= MAX_THREADS; n_threads *= 2) {
+        LockedMap locked;
+        ConcurrentUnorderedMap<size_t, size_t> sharded;
+
+        double locked_mops = run(locked, n_threads);
+        double sharded_mops = run(sharded, n_threads);
+        std::cout << std::setw(8) << n_threads << std::fixed << std::setprecision(1)
+                  << std::setw(12) << locked_mops << " M/s"
+                  << std::setw(12) << sharded_mops << " M/s" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "UnorderedMap.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+    Copying and clearing maps of N_ELEMENTS elements, against
+    std::unordered_map: the copy constructor and copy assignment with
+    size_t keys and with string keys, whose hash codes the map caches, and
+    clear() on the full map. The last case is a map reserved for
+    N_ELEMENTS which is filled with SPARSE_ELEMENTS elements and cleared
+    again N_ROUNDS times, as a scratch map reused across the iterations of
+    a loop is; its clear() costs what the elements cost, not the buckets.
+*/
+
+constexpr size_t N_ELEMENTS = 1 << 20;
+constexpr size_t SPARSE_ELEMENTS = 64;
+constexpr size_t N_ROUNDS = 1000;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(std::string const & name, std::string const & what, double seconds) {
+    std::cout << "  " << std::left << std::setw(24) << name << std::setw(22) << what << std::right
+              << std::fixed << std::setprecision(1) << std::setw(9) << seconds * 1e3 << " ms" << std::endl;
+}
+
+template<typename Map, typename Key>
+void copy_and_clear(std::string const & name, std::vector<Key> const & keys) {
+    Map map(keys.size());
+    map.max_load_factor(1.0f);
+    for(size_t i = 0; i < keys.size(); i++)
+        map.insert({keys[i], i});
+
+    auto start = std::chrono::steady_clock::now();
+    Map copy(map);
+    report(name, "copy constructor", seconds_since(start));
+
+    Map assigned(0);
+    assigned.insert({keys[0], 0});
+    start = std::chrono::steady_clock::now();
+    assigned = map;
+    report(name, "copy assignment", seconds_since(start));
+
+    start = std::chrono::steady_clock::now();
+    copy.clear();
+    report(name, "clear, full", seconds_since(start));
+
+    if(copy.size() + assigned.size() != map.size())
+        std::cout << "  size mismatch" << std::endl;
+}
+
+template<typename Map>
+void sparse_clear(std::string const & name, std::vector<size_t> const & keys) {
+    Map map(N_ELEMENTS);
+    map.max_load_factor(1.0f);
+    size_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(size_t round = 0; round < N_ROUNDS; round++) {
+        for(size_t i = 0; i < SPARSE_ELEMENTS; i++)
+            map.insert({keys[round * SPARSE_ELEMENTS + i], i});
+        total += map.size();
+        map.clear();
+    }
+    report(name, "fill + clear, sparse", seconds_since(start));
+    if(total != N_ROUNDS * SPARSE_ELEMENTS)
+        std::cout << "  size mismatch" << std::endl;
+}
+
+int main() {
+    std::mt19937_64 generator(221);
+    std::vector<size_t> keys(N_ELEMENTS);
+    for(size_t & key : keys)
+        key = generator();
+    std::vector<std::string> string_keys;
+    for(size_t key : keys)
+        string_keys.push_back("key-" + std::to_string(key));
+
+    std::cout << N_ELEMENTS << " size_t keys:" << std::endl;
+    copy_and_clear<std::unordered_map<size_t, size_t>>("std::unordered_map", keys);
+    copy_and_clear<UnorderedMap<size_t, size_t>>("UnorderedMap", keys);
+
+    std::cout << N_ELEMENTS << " string keys:" << std::endl;
+    copy_and_clear<std::unordered_map<std::string, size_t>>("std::unordered_map", string_keys);
+    copy_and_clear<UnorderedMap<std::string, size_t>>("UnorderedMap", string_keys);
+
+    std::cout << N_ROUNDS << " rounds of " << SPARSE_ELEMENTS << " elements in " << N_ELEMENTS
+              << " buckets:" << std::endl;
+    sparse_clear<std::unordered_map<size_t, size_t>>("std::unordered_map", keys);
+    sparse_clear<UnorderedMap<size_t, size_t>>("UnorderedMap", keys);
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "UnorderedMap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+    Erase throughput. Each round fills a map with N_ELEMENTS random keys at
+    a max_load_factor of LOAD_FACTOR, so that buckets hold long chains and
+    any walk of a chain shows, then empties it again one of three ways:
+    erase(find(key)) in random key order, an it = erase(it) sweep from
+    begin(), and erase_if, which the sweep is the hand-written form of.
+    Only the erasing is timed. The last two also run with a predicate that
+    keeps every other element, the usual shape of a filtering pass.
+*/
+
+constexpr size_t N_ELEMENTS = 1 << 20;
+constexpr float LOAD_FACTOR = 8.0f;
+
+using Map = UnorderedMap<size_t, size_t>;
+
+Map filled(std::vector<size_t> const & keys) {
+    Map map(0);
+    map.max_load_factor(LOAD_FACTOR);
+    for(size_t key : keys)
+        map.insert({key, key});
+    return map;
+}
+
+template<typename Erase>
+void bench(std::string const & name, std::vector<size_t> const & keys, Erase erase) {
+    Map map = filled(keys);
+    auto start = std::chrono::steady_clock::now();
+    size_t erased = erase(map);
+    auto stop = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    std::cout << "  " << std::left << std::setw(28) << name << std::right
+              << std::fixed << std::setprecision(1) << std::setw(7) << (erased / seconds) / 1e6 << " M erases/s"
+              << "  (left: " << map.size() << ")" << std::endl;
+}
+
+int main() {
+    std::mt19937_64 generator(221);
+    std::vector<size_t> keys(N_ELEMENTS);
+    for(size_t & key : keys)
+        key = generator();
+    std::vector<size_t> order = keys;
+    std::shuffle(order.begin(), order.end(), generator);
+
+    std::cout << N_ELEMENTS << " elements, max load factor " << LOAD_FACTOR << ":" << std::endl;
+
+    bench("erase(find(key))", keys, [&](Map & map) {
+        for(size_t key : order)
+            map.erase(map.find(key));
+        return order.size();
+    });
+
+    bench("it = erase(it), all", keys, [](Map & map) {
+        size_t erased = 0;
+        for(auto it = map.begin(); it != map.end(); erased++)
+            it = map.erase(it);
+        return erased;
+    });
+
+    bench("erase_if, all", keys, [](Map & map) {
+        return map.erase_if([](auto const &) { return true; });
+    });
+
+    bench("it = erase(it), odd keys", keys, [](Map & map) {
+        size_t erased = 0;
+        for(auto it = map.begin(); it != map.end();) {
+            if(it->first % 2 == 1) {
+                it = map.erase(it);
+                erased++;
+            } else {
+                ++it;
+            }
+        }
+        return erased;
+    });
+
+    bench("erase_if, odd keys", keys, [](Map & map) {
+        return map.erase_if([](auto const & pair) { return pair.first % 2 == 1; });
+    });
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "UnorderedMap.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+    Scalar find against find_batch. Each map holds random size_t keys at a
+    load factor of at most 1.0 and answers N_LOOKUPS successful lookups in
+    random order, summing the values found. find_batch is called on blocks
+    of BLOCK keys, so its output stays in cache. The small map fits in cache;
+    the large one (about 700 MB of nodes and buckets) is far beyond L3,
+    where every lookup misses on its bucket and nodes.
+*/
+
+constexpr size_t SMALL_ELEMENTS = 1 << 16;
+constexpr size_t LARGE_ELEMENTS = 1 << 24;
+constexpr size_t N_LOOKUPS = 1 << 24;
+constexpr size_t BLOCK = 256;
+
+using Map = UnorderedMap<size_t, size_t>;
+
+template<typename Lookup>
+void bench(std::string const & name, std::vector<size_t> const & lookups, Lookup lookup) {
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = lookup();
+    auto stop = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    std::cout << std::setw(12) << name << ": "
+              << std::fixed << std::setprecision(1) << (lookups.size() / seconds) / 1e6 << " M lookups/s"
+              << "  (checksum: " << checksum << ")" << std::endl;
+}
+
+void bench_all(size_t n_elements, std::mt19937_64 & generator) {
+    std::vector<std::pair<size_t, size_t>> pairs(n_elements);
+    for(auto & pair : pairs)
+        pair = {generator(), generator() >> 32};
+
+    std::vector<size_t> lookups(N_LOOKUPS);
+    std::uniform_int_distribution<size_t> index(0, pairs.size() - 1);
+    for(size_t & key : lookups)
+        key = pairs[index(generator)].first;
+
+    Map map(pairs.begin(), pairs.end());
+
+    std::cout << "Lookups, " << n_elements << " keys, " << map.bucket_count() << " buckets:" << std::endl;
+
+    bench("find", lookups, [&] {
+        size_t checksum = 0;
+        for(size_t key : lookups)
+            checksum += map.find(key)->second;
+        return checksum;
+    });
+
+    bench("find_batch", lookups, [&] {
+        size_t checksum = 0;
+        Map::iterator found[BLOCK];
+        for(size_t i = 0; i < lookups.size(); i += BLOCK) {
+            size_t n = std::min(BLOCK, lookups.size() - i);
+            map.find_batch(lookups.begin() + i, lookups.begin() + i + n, found);
+            for(size_t j = 0; j < n; j++)
+                checksum += found[j]->second;
+        }
+        return checksum;
+    });
+
+    std::cout << std::endl;
+}
+
+int main() {
+    std::mt19937_64 generator(221);
+
+    bench_all(SMALL_ELEMENTS, generator);
+    bench_all(LARGE_ELEMENTS, generator);
+
+    return 0;
+}
@@ -0,0 +1,268 @@
+#include "UnorderedMap.h"
+#include "hash_selector.h"
+
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/*
+    Hash quality report, non-interactive. Every hasher in HASH_TYPES (and
+    any listed in main below) hashes each key set, and one row per (key set,
+    hasher) is printed as CSV or JSON for regression tracking.
+
+    Usage: hash_analysis [--elements N] [--buckets N] [--lookups N] [--format csv|json] [key files...]
+
+    A key file holds one key per line; duplicates are dropped and only the
+    first N distinct keys are kept. Without key files the key sets are N
+    random "Adjective Animal" names like the ones main.cpp inserts, and the
+    two word lists in ../data_files. --buckets 0, the default, asks for one
+    bucket per key.
+
+    Columns:
+    - load_variance: the statistic main.cpp prints, about 1 for a uniform hash.
+    - chi_squared: Pearson's statistic of the bucket sizes against a uniform
+      spread, and chi_squared_z the same as a standard score, which stays
+      within a few units of 0 for a uniform hash.
+    - max_chain: the largest bucket.
+    - avalanche_mean: the fraction of output bits which change when one bit
+      of a key is flipped (ideally 0.5), over up to the first 256 bits of
+      AVALANCHE_KEYS keys. avalanche_max_bias is the worst distance of any
+      single output bit from 0.5.
+    - ns_per_hash: hashing the keys in a loop.
+    - ns_per_lookup: successful finds of random keys in the map the bucket
+      statistics came from.
+*/
+
+constexpr size_t AVALANCHE_KEYS = 100;
+constexpr size_t AVALANCHE_BITS = 256;
+
+struct Options {
+    size_t elements = 10000;
+    size_t buckets = 0;
+    size_t lookups = 100000;
+    bool json = false;
+    std::vector<std::string> key_files;
+};
+
+struct KeySet {
+    std::string name;
+    std::vector<std::string> keys;
+};
+
+struct Report {
+    std::string keys;
+    std::string hasher;
+    size_t n_keys;
+    size_t buckets;
+    double load_factor;
+    double load_variance;
+    double chi_squared;
+    double chi_squared_z;
+    size_t max_chain;
+    double avalanche_mean;
+    double avalanche_max_bias;
+    double ns_per_hash;
+    double ns_per_lookup;
+};
+
+// Keeps the timed loops from being optimised away
+volatile size_t checksum_sink;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Hash>
+Report analyse(KeySet const & key_set, std::string const & hasher, Hash hash, Options const & options) {
+    std::vector<std::string> const & keys = key_set.keys;
+    Report report{key_set.name, hasher, keys.size()};
+
+    UnorderedMap<std::string, size_t, Hash> map(options.buckets == 0 ? keys.size() : options.buckets, hash);
+    for(size_t i = 0; i < keys.size(); i++)
+        map.insert({keys[i], i});
+    report.buckets = map.bucket_count();
+    report.load_factor = map.load_factor();
+
+    // Bucket statistics
+    double expected = static_cast<double>(map.size()) / map.bucket_count();
+    for(size_t bucket = 0; bucket < map.bucket_count(); bucket++) {
+        double size = map.bucket_size(bucket);
+        report.load_variance += (size - map.load_factor()) * (size - map.load_factor());
+        report.chi_squared += (size - expected) * (size - expected) / expected;
+        report.max_chain = std::max(report.max_chain, map.bucket_size(bucket));
+    }
+    report.load_variance /= map.size() - 1;
+    double freedom = map.bucket_count() - 1.0;
+    report.chi_squared_z = (report.chi_squared - freedom) / std::sqrt(2 * freedom);
+
+    // Avalanche
+    size_t flips[64] = {};
+    size_t trials = 0;
+    for(size_t i = 0; i < keys.size() && i < AVALANCHE_KEYS; i++) {
+        std::string key = keys[i * keys.size() / std::min(keys.size(), AVALANCHE_KEYS)];
+        size_t original = hash(key);
+        for(size_t bit = 0; bit < 8 * key.size() && bit < AVALANCHE_BITS; bit++) {
+            key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+            std::bitset<64> changed = original ^ hash(key);
+            key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+            for(size_t out = 0; out < 64; out++)
+                flips[out] += changed[out];
+            trials++;
+        }
+    }
+    if(trials > 0) {
+        for(size_t out = 0; out < 64; out++) {
+            double rate = static_cast<double>(flips[out]) / trials;
+            report.avalanche_mean += rate / 64;
+            report.avalanche_max_bias = std::max(report.avalanche_max_bias, std::abs(rate - 0.5));
+        }
+    }
+
+    // Timings
+    size_t checksum = 0;
+    size_t rounds = std::max<size_t>(1, options.lookups / keys.size());
+    auto start = std::chrono::steady_clock::now();
+    for(size_t round = 0; round < rounds; round++)
+        for(std::string const & key : keys)
+            checksum += hash(key);
+    report.ns_per_hash = seconds_since(start) * 1e9 / (rounds * keys.size());
+
+    std::mt19937_64 generator(221);
+    std::vector<std::string const *> lookups(options.lookups);
+    for(auto & key : lookups)
+        key = &keys[generator() % keys.size()];
+    start = std::chrono::steady_clock::now();
+    for(std::string const * key : lookups)
+        checksum += map.find(*key)->second;
+    report.ns_per_lookup = seconds_since(start) * 1e9 / lookups.size();
+
+    checksum_sink = checksum;
+    return report;
+}
+
+std::vector<std::string> read_lines(std::string const & path, size_t limit) {
+    std::ifstream file(path);
+    if(!file) {
+        std::cerr << "Cannot open " << path << std::endl;
+        std::exit(1);
+    }
+
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> keys;
+    std::string line;
+    while(keys.size() < limit && std::getline(file, line))
+        if(seen.insert(line).second)
+            keys.push_back(line);
+    return keys;
+}
+
+// Distinct "Adjective Animal" names, drawn the way main.cpp's AnimalDistribution draws them
+std::vector<std::string> animal_names(std::vector<std::string> const & adjectives,
+                                      std::vector<std::string> const & animals, size_t limit) {
+    limit = std::min(limit, adjectives.size() * animals.size());
+    std::mt19937_64 generator(221);
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> keys;
+    while(keys.size() < limit) {
+        std::string adjective = adjectives[generator() % adjectives.size()];
+        adjective[0] = std::toupper(adjective[0]);
+        std::string name = adjective + " " + animals[generator() % animals.size()];
+        if(seen.insert(name).second)
+            keys.push_back(name);
+    }
+    return keys;
+}
+
+Options parse_options(int argc, char ** argv) {
+    Options options;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(arg == "--elements" && has_value)
+            options.elements = std::stoull(argv[++i]);
+        else if(arg == "--buckets" && has_value)
+            options.buckets = std::stoull(argv[++i]);
+        else if(arg == "--lookups" && has_value)
+            options.lookups = std::stoull(argv[++i]);
+        else if(arg == "--format" && has_value)
+            options.json = std::string(argv[++i]) == "json";
+        else if(arg.rfind("--", 0) == 0) {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--elements N] [--buckets N] [--lookups N] [--format csv|json] [key files...]" << std::endl;
+            std::exit(1);
+        }
+        else
+            options.key_files.push_back(arg);
+    }
+    return options;
+}
+
+void print(std::vector<Report> const & reports, bool json) {
+    std::cout << std::setprecision(6);
+    if(!json) {
+        std::cout << "keys,hasher,n_keys,buckets,load_factor,load_variance,chi_squared,chi_squared_z,max_chain,"
+                     "avalanche_mean,avalanche_max_bias,ns_per_hash,ns_per_lookup" << std::endl;
+        for(Report const & r : reports)
+            std::cout << r.keys << ',' << r.hasher << ',' << r.n_keys << ',' << r.buckets << ','
+                      << r.load_factor << ',' << r.load_variance << ',' << r.chi_squared << ','
+                      << r.chi_squared_z << ',' << r.max_chain << ',' << r.avalanche_mean << ','
+                      << r.avalanche_max_bias << ',' << r.ns_per_hash << ',' << r.ns_per_lookup << std::endl;
+        return;
+    }
+
+    std::cout << "[" << std::endl;
+    for(size_t i = 0; i < reports.size(); i++) {
+        Report const & r = reports[i];
+        std::cout << "  {\"keys\": \"" << r.keys << "\", \"hasher\": \"" << r.hasher << "\", \"n_keys\": " << r.n_keys
+                  << ", \"buckets\": " << r.buckets << ", \"load_factor\": " << r.load_factor
+                  << ", \"load_variance\": " << r.load_variance << ", \"chi_squared\": " << r.chi_squared
+                  << ", \"chi_squared_z\": " << r.chi_squared_z << ", \"max_chain\": " << r.max_chain
+                  << ", \"avalanche_mean\": " << r.avalanche_mean << ", \"avalanche_max_bias\": " << r.avalanche_max_bias
+                  << ", \"ns_per_hash\": " << r.ns_per_hash << ", \"ns_per_lookup\": " << r.ns_per_lookup << "}"
+                  << (i + 1 < reports.size() ? "," : "") << std::endl;
+    }
+    std::cout << "]" << std::endl;
+}
+
+int main(int argc, char ** argv) {
+    Options options = parse_options(argc, argv);
+
+    std::vector<KeySet> key_sets;
+    if(options.key_files.empty()) {
+        std::vector<std::string> adjectives = read_lines("../data_files/adjectives.txt", SIZE_MAX);
+        std::vector<std::string> animals = read_lines("../data_files/animals.txt", SIZE_MAX);
+        key_sets.push_back({"animal_names", animal_names(adjectives, animals, options.elements)});
+        adjectives.resize(std::min(adjectives.size(), options.elements));
+        animals.resize(std::min(animals.size(), options.elements));
+        key_sets.push_back({"adjectives.txt", adjectives});
+        key_sets.push_back({"animals.txt", animals});
+    }
+    for(std::string const & path : options.key_files)
+        key_sets.push_back({path, read_lines(path, options.elements)});
+
+    std::vector<Report> reports;
+    for(KeySet const & key_set : key_sets) {
+        if(key_set.keys.size() < 2)
+            continue;
+
+        for(HashType htype : HASH_TYPES)
+            reports.push_back(with_hash(htype, [&](auto hash) {
+                return analyse(key_set, hash_type_name(htype), hash, options);
+            }));
+
+        // Hashers outside HASH_TYPES: add a line here to compare your own
+        reports.push_back(analyse(key_set, "std::hash", std::hash<std::string>{}, options));
+    }
+
+    print(reports, options.json);
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "FlatUnorderedMap.h"
+#include "IntegerUnorderedMap.h"
+#include "UnorderedMap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+    IntegerUnorderedMap against UnorderedMap, FlatUnorderedMap and
+    std::unordered_map on an ID remapping job: N_KEYS keys, either dense
+    (0 .. N_KEYS, shuffled) or random 64-bit IDs, are inserted one by one,
+    then looked up N_LOOKUPS times in random order, half of the lookups
+    hits and half misses. Each map is grown by its inserts, without a
+    reserve, UnorderedMap at std::unordered_map's load factor of 1. The memory column is key and value storage per element for
+    IntegerUnorderedMap (bytes_per_entry()), and for the node maps an
+    estimate: a 32-byte malloc chunk per 16-byte node plus 8 bytes per
+    bucket.
+*/
+
+constexpr size_t N_KEYS = 1 << 20;
+constexpr size_t N_LOOKUPS = 1 << 23;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Map>
+double bytes_per_entry(Map const & map) {
+    if constexpr (std::is_same<Map, IntegerUnorderedMap<typename Map::key_type, typename Map::mapped_type>>::value) {
+        return map.bytes_per_entry();
+    } else {
+        return (32.0 * map.size() + 8.0 * map.bucket_count()) / map.size();
+    }
+}
+
+template<typename Map, typename Key>
+void bench(std::string const & name, std::vector<Key> const & keys, std::vector<Key> const & lookups) {
+    auto start = std::chrono::steady_clock::now();
+    Map map(0);
+    // UnorderedMap's maximum load factor starts at infinity; use std::unordered_map's
+    if constexpr (std::is_same<Map, UnorderedMap<Key, uint32_t>>::value)
+        map.max_load_factor(1.0f);
+    for(size_t i = 0; i < keys.size(); i++)
+        map.insert({keys[i], static_cast<uint32_t>(i)});
+    double insert = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for(Key key : lookups) {
+        auto it = map.find(key);
+        if(it != map.end())
+            sum += it->second;
+    }
+    double find = seconds_since(start);
+
+    std::cout << "  " << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << insert * 1e3 << " ms to insert, " << std::setw(6) << (lookups.size() / find) / 1e6
+              << " M finds/s, " << std::setw(5) << bytes_per_entry(map) << " bytes/entry  (sum: " << sum << ")"
+              << std::endl;
+}
+
+template<typename Key>
+void bench_all(std::string const & title, std::vector<Key> keys, std::mt19937_64 & generator) {
+    // Half of the lookups are keys of the map, half are keys which are not
+    std::vector<Key> lookups(N_LOOKUPS);
+    for(size_t i = 0; i < N_LOOKUPS; i++)
+        lookups[i] = i % 2 == 0 ? keys[generator() % keys.size()] : static_cast<Key>(keys.size() + generator() % keys.size());
+    if constexpr (sizeof(Key) == 8) {
+        for(size_t i = 1; i < N_LOOKUPS; i += 2)
+            lookups[i] = static_cast<Key>(generator() | 1);
+    }
+
+    std::cout << title << ":" << std::endl;
+    bench<std::unordered_map<Key, uint32_t>>("std::unordered_map", keys, lookups);
+    bench<UnorderedMap<Key, uint32_t>>("UnorderedMap", keys, lookups);
+    bench<FlatUnorderedMap<Key, uint32_t>>("FlatUnorderedMap", keys, lookups);
+    bench<IntegerUnorderedMap<Key, uint32_t>>("IntegerUnorderedMap", keys, lookups);
+}
+
+int main() {
+    std::mt19937_64 generator(221);
+
+    std::vector<int> dense(N_KEYS);
+    for(size_t i = 0; i < N_KEYS; i++)
+        dense[i] = static_cast<int>(i);
+    std::shuffle(dense.begin(), dense.end(), generator);
+    bench_all("Dense int keys", dense, generator);
+
+    std::vector<uint64_t> ids(N_KEYS);
+    for(uint64_t & id : ids)
+        id = generator() & ~uint64_t{1};
+    bench_all("Random uint64_t IDs", ids, generator);
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "UnorderedMap.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+    What the statistics policy costs and what it shows. N_KEYS random keys
+    are inserted and N_LOOKUPS lookups made, half of them for inserted
+    keys and half for random ones, mostly misses, with the default
+    no_map_stats, which should time the same as a map before the policy
+    existed, and with counting_map_stats. Then the counters of two
+    maps holding the same keys are printed side by side: one with
+    std::hash, the other with a hash which drops the low bits of the key,
+    so keys close together share a code and the histogram grows a tail.
+*/
+
+constexpr size_t N_KEYS = 1 << 20;
+constexpr size_t N_LOOKUPS = 1 << 23;
+
+template<typename Stats, typename Hash = std::hash<int>>
+using Map = UnorderedMap<int, int, Hash, std::equal_to<int>, prime_range_hash,
+                         std::allocator<std::pair<const int, int>>, Stats>;
+
+// Drops the low 8 bits, so runs of 256 keys share one hash code
+struct coarse_hash {
+    size_t operator()(int key) const { return static_cast<unsigned>(key) >> 8; }
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Stats>
+void timed(std::string const & name, std::vector<int> const & keys, std::vector<int> const & lookups) {
+    auto start = std::chrono::steady_clock::now();
+    Map<Stats> map(0);
+    map.max_load_factor(1.0f);
+    for(size_t i = 0; i < keys.size(); i++)
+        map.insert({keys[i], static_cast<int>(i)});
+    double build = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    size_t found = 0;
+    for(int key : lookups)
+        found += map.count(key);
+    double find = seconds_since(start);
+    std::cout << std::fixed << std::setprecision(1) << "  " << std::left << std::setw(22) << name << std::right
+              << std::setw(8) << build * 1e3 << " ms to insert, " << std::setw(6)
+              << lookups.size() / find / 1e6 << " M lookups/s  (found: " << found << ")" << std::endl;
+}
+
+void print(std::string const & name, map_stats const & stats) {
+    std::cout << "  " << name << ": " << stats.hits << " hits, " << stats.misses << " misses, "
+              << stats.rehashes << " rehashes, mean probe " << std::setprecision(2) << stats.mean_probe_length()
+              << ", longest probe " << stats.longest_probe << ", longest chain " << stats.max_chain << std::endl;
+    std::cout << "    keys compared:";
+    for(size_t k = 0; k < map_stats::PROBE_LENGTHS; k++)
+        std::cout << " " << k << (k + 1 == map_stats::PROBE_LENGTHS ? "+:" : ":") << stats.probe_lengths[k];
+    std::cout << std::endl;
+}
+
+template<typename Hash>
+map_stats counted(std::vector<int> const & keys, std::vector<int> const & lookups) {
+    Map<counting_map_stats, Hash> map(0);
+    map.max_load_factor(1.0f);
+    for(size_t i = 0; i < keys.size(); i++)
+        map.insert({keys[i], static_cast<int>(i)});
+    map.reset_stats();
+    for(int key : lookups)
+        map.count(key);
+    return map.stats();
+}
+
+int main() {
+    std::mt19937 generator(221);
+    std::vector<int> keys;
+    for(size_t i = 0; i < N_KEYS; i++)
+        keys.push_back(static_cast<int>(generator() % (4 * N_KEYS)));
+    std::vector<int> lookups;
+    for(size_t i = 0; i < N_LOOKUPS; i++)
+        lookups.push_back(i % 2 == 0 ? keys[generator() % N_KEYS] : static_cast<int>(generator() % (4 * N_KEYS)));
+
+    std::cout << N_KEYS << " inserts, " << N_LOOKUPS << " lookups:" << std::endl;
+    timed<no_map_stats>("no_map_stats", keys, lookups);
+    timed<counting_map_stats>("counting_map_stats", keys, lookups);
+
+    std::vector<int> fewer(keys.begin(), keys.begin() + N_KEYS / 16);
+    std::vector<int> fewer_lookups;
+    for(size_t i = 0; i < N_LOOKUPS / 16; i++)
+        fewer_lookups.push_back(i % 2 == 0 ? fewer[generator() % fewer.size()]
+                                           : static_cast<int>(generator() % (4 * N_KEYS)));
+    std::cout << "Lookup counters after " << fewer.size() << " inserts, " << fewer_lookups.size()
+              << " lookups:" << std::endl;
+    print("std::hash", counted<std::hash<int>>(fewer, fewer_lookups));
+    print("coarse_hash", counted<coarse_hash>(fewer, fewer_lookups));
+    return 0;
+}
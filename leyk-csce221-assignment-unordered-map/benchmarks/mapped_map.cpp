@@ -0,0 +1,88 @@
+#include "MappedUnorderedMap.h"
+#include "UnorderedMap.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+    Startup cost of a large string table: parsing N_KEYS "key value" lines
+    into an UnorderedMap, as a service would at every start, against
+    opening a MappedUnorderedMap image of the same table. Both are followed
+    by N_LOOKUPS random finds. The files are read right after being written,
+    so they come from the page cache; from a cold disk, opening the image
+    stays O(1) and the lookups pay the page faults.
+*/
+
+constexpr size_t N_KEYS = 1 << 21;
+constexpr size_t N_LOOKUPS = 1 << 20;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    std::string text_path = "build/mapped_map.txt";
+    std::string image_path = "build/mapped_map.img";
+
+    std::vector<std::string> keys;
+    std::mt19937_64 generator(221);
+    {
+        std::ofstream text(text_path);
+        for(size_t i = 0; i < N_KEYS; i++) {
+            keys.push_back("/srv/data/shard-" + std::to_string(generator() % 1000) + "/object-" + std::to_string(i));
+            text << keys.back() << ' ' << i << '\n';
+        }
+    }
+    std::vector<std::string const *> lookups;
+    for(size_t i = 0; i < N_LOOKUPS; i++)
+        lookups.push_back(&keys[generator() % keys.size()]);
+
+    std::cout << N_KEYS << " keys, then " << N_LOOKUPS << " finds:" << std::endl;
+
+    // Parse the text into a map
+    auto start = std::chrono::steady_clock::now();
+    UnorderedMap<std::string, int, fnv1a_hash> map(0);
+    {
+        map.max_load_factor(1.0f);
+        std::ifstream text(text_path);
+        std::string key;
+        int value;
+        while(text >> key >> value)
+            map.insert({key, value});
+    }
+    double load = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    size_t checksum = 0;
+    for(std::string const * key : lookups)
+        checksum += map.find(*key)->second;
+    double find = seconds_since(start);
+    std::cout << std::fixed << std::setprecision(3)
+              << "  parse text:  " << std::setw(8) << load * 1e3 << " ms to load, "
+              << std::setw(8) << find * 1e3 << " ms to find  (checksum: " << checksum << ")" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    MappedUnorderedMap<int>::write(image_path, map);
+    std::cout << "  write image: " << std::setw(8) << seconds_since(start) * 1e3 << " ms, once" << std::endl;
+
+    // Open the image
+    start = std::chrono::steady_clock::now();
+    MappedUnorderedMap<int> image(image_path);
+    load = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    checksum = 0;
+    for(std::string const * key : lookups)
+        checksum += image.find(*key)->second;
+    find = seconds_since(start);
+    std::cout << "  open image:  " << std::setw(8) << load * 1e3 << " ms to load, "
+              << std::setw(8) << find * 1e3 << " ms to find  (checksum: " << checksum << ")" << std::endl;
+
+    std::remove(text_path.c_str());
+    std::remove(image_path.c_str());
+    return 0;
+}
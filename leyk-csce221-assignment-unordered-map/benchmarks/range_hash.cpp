@@ -0,0 +1,69 @@
+#include "UnorderedMap.h"
+#include "range_hash.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+    Lookup throughput of UnorderedMap under each range hashing policy.
+    For each size, every map holds the same keys at a maximum load factor of
+    1.0 and answers the same N_LOOKUPS successful finds in random order. The
+    small map fits in cache, so it shows the cost of the reduction itself; in
+    the large one cache misses on the nodes dominate.
+*/
+
+constexpr size_t SMALL_ELEMENTS = 1 << 12;
+constexpr size_t LARGE_ELEMENTS = 1 << 20;
+constexpr size_t N_LOOKUPS = 1 << 24;
+
+template<typename RangeHash>
+void bench(std::string const & name, std::vector<size_t> const & keys, std::vector<size_t> const & lookups) {
+    using Map = UnorderedMap<size_t, size_t, std::hash<size_t>, std::equal_to<size_t>, RangeHash>;
+
+    Map map(0);
+    map.max_load_factor(1.0f);
+    map.reserve(keys.size());
+    for(size_t key : keys)
+        map.insert({key, key});
+
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = 0;
+    for(size_t key : lookups)
+        checksum += map.find(key)->second;
+    auto stop = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    std::cout << std::setw(10) << name << ": "
+              << std::fixed << std::setprecision(1) << (lookups.size() / seconds) / 1e6 << " M lookups/s"
+              << "  (buckets: " << map.bucket_count() << ", checksum: " << checksum << ")" << std::endl;
+}
+
+void bench_all(size_t n_elements, std::mt19937_64 & generator) {
+    std::vector<size_t> keys(n_elements);
+    for(size_t & key : keys)
+        key = generator();
+
+    std::vector<size_t> lookups(N_LOOKUPS);
+    std::uniform_int_distribution<size_t> index(0, keys.size() - 1);
+    for(size_t & key : lookups)
+        key = keys[index(generator)];
+
+    std::cout << "Range hashing, " << n_elements << " keys, " << N_LOOKUPS << " lookups:" << std::endl;
+    bench<prime_range_hash>("prime", keys, lookups);
+    bench<fastmod_range_hash>("fastmod", keys, lookups);
+    bench<pow2_range_hash>("pow2", keys, lookups);
+    std::cout << std::endl;
+}
+
+int main() {
+    std::mt19937_64 generator(221);
+
+    bench_all(SMALL_ELEMENTS, generator);
+    bench_all(LARGE_ELEMENTS, generator);
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "ConcurrentUnorderedMap.h"
+#include "RcuUnorderedMap.h"
+#include "UnorderedMap.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    Read-mostly throughput of RcuUnorderedMap against ConcurrentUnorderedMap
+    and one UnorderedMap behind one reader/writer lock, from 1 to 64
+    threads. The map holds N_KEYS keys, the size of a routing table, and
+    N_OPERATIONS operations are split evenly over the threads: 99.9% finds
+    and 0.1% insert_or_assign, on scrambled keys drawn uniformly. Threads
+    beyond the machine's core count only add contention.
+*/
+
+constexpr size_t N_KEYS = 1 << 16;
+constexpr size_t N_OPERATIONS = 1 << 22;
+constexpr size_t MAX_THREADS = 64;
+
+size_t scramble(size_t index) {
+    return index * 0x9E3779B97F4A7C15ull;
+}
+
+// The reader/writer lock baseline, with the same interface the benchmark uses
+class SharedLockedMap {
+    mutable std::shared_mutex _mutex;
+    UnorderedMap<size_t, size_t> _map;
+
+public:
+    SharedLockedMap() : _map(0) {
+        _map.max_load_factor(1.0f);
+    }
+
+    bool contains(size_t key) const {
+        std::shared_lock lock(_mutex);
+        return _map.contains(key);
+    }
+
+    bool insert_or_assign(size_t key, size_t value) {
+        std::unique_lock lock(_mutex);
+        return _map.insert_or_assign(key, value).second;
+    }
+};
+
+template<typename Map>
+double run(Map & map, size_t n_threads) {
+    for(size_t index = 0; index < N_KEYS; index++)
+        map.insert_or_assign(scramble(index), index);
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for(size_t thread = 0; thread < n_threads; thread++) {
+        threads.emplace_back([&map, n_threads, thread] {
+            std::mt19937_64 generator(221 + thread);
+            size_t hits = 0;
+            for(size_t i = 0; i < N_OPERATIONS / n_threads; i++) {
+                size_t random = generator();
+                size_t key = scramble(random % N_KEYS);
+                if((random >> 32) % 1000 == 0)
+                    map.insert_or_assign(key, random);
+                else
+                    hits += map.contains(key);
+            }
+            if(hits == ~size_t{0})
+                std::cout << hits;
+        });
+    }
+    for(auto & thread : threads)
+        thread.join();
+    auto stop = std::chrono::steady_clock::now();
+
+    return N_OPERATIONS / std::chrono::duration<double>(stop - start).count() / 1e6;
+}
+
+int main() {
+    std::cout << "Read-mostly operations (99.9% find), " << N_OPERATIONS << " in total, "
+              << std::thread::hardware_concurrency() << " hardware threads:" << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "shared_mutex" << std::setw(16) << "sharded"
+              << std::setw(16) << "rcu" << std::endl;
+
+    for(size_t n_threads = 1; n_threads <= MAX_THREADS; n_threads *= 2) {
+        SharedLockedMap locked;
+        ConcurrentUnorderedMap<size_t, size_t> sharded;
+        RcuUnorderedMap<size_t, size_t> rcu;
+
+        double locked_mops = run(locked, n_threads);
+        double sharded_mops = run(sharded, n_threads);
+        double rcu_mops = run(rcu, n_threads);
+        std::cout << std::setw(8) << n_threads << std::fixed << std::setprecision(1)
+                  << std::setw(12) << locked_mops << " M/s"
+                  << std::setw(12) << sharded_mops << " M/s"
+                  << std::setw(12) << rcu_mops << " M/s" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "UnorderedMap.h"
+#include "hash_functions.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+    What sip_hash and the chain length watchdog cost, and what they buy.
+
+    The first table inserts and then finds N_KEYS ordinary keys (short
+    "user:<n>" ids and 60 byte URLs) at a maximum load factor of 1.0, with
+    fnv1a_hash, sip_hash, and sip_hash with max_chain_length(16).
+
+    The second inserts and finds N_FLOOD keys an attacker picked knowing the
+    hasher is fnv1a_hash and the map has a fixed bucket count: every one of
+    them lands in bucket 0. Under fnv1a_hash the map is one long list; the
+    same keys mean nothing to sip_hash's random key.
+*/
+
+constexpr size_t N_KEYS = 1 << 20;
+constexpr size_t N_FLOOD = 1 << 13;
+
+template<typename Hash>
+void bench(std::string const & name, std::vector<std::string> const & keys, float max_load_factor,
+           size_t bucket_count, size_t max_chain = 0) {
+    using Map = UnorderedMap<std::string, size_t, Hash>;
+
+    auto start = std::chrono::steady_clock::now();
+    Map map(bucket_count);
+    map.max_load_factor(max_load_factor);
+    if constexpr (_unordered_map_reseedable<Hash>::value)
+        map.max_chain_length(max_chain);
+    for(size_t i = 0; i < keys.size(); i++)
+        map.insert({keys[i], i});
+    size_t checksum = 0;
+    for(auto const & key : keys)
+        checksum += map.find(key)->second;
+    auto stop = std::chrono::steady_clock::now();
+
+    size_t longest = 0;
+    for(size_t bucket = 0; bucket < map.bucket_count(); bucket++)
+        longest = std::max(longest, map.bucket_size(bucket));
+
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    std::cout << std::setw(22) << name << ": " << std::fixed << std::setprecision(3)
+              << std::setw(9) << seconds * 1e3 << " ms, " << std::setprecision(1)
+              << std::setw(6) << 2 * keys.size() / seconds / 1e6 << " M ops/s"
+              << "  (longest chain: " << longest << ", checksum: " << checksum << ")" << std::endl;
+}
+
+template<typename MakeKey>
+void bench_keys(std::string const & title, MakeKey make_key) {
+    std::vector<std::string> keys;
+    for(size_t i = 0; i < N_KEYS; i++)
+        keys.push_back(make_key(i));
+
+    std::cout << title << ", " << N_KEYS << " inserts and finds:" << std::endl;
+    bench<fnv1a_hash>("fnv1a", keys, 1.0f, 0);
+    bench<sip_hash>("sip", keys, 1.0f, 0);
+    bench<sip_hash>("sip, max chain 16", keys, 1.0f, 0, 16);
+    std::cout << std::endl;
+}
+
+int main() {
+    bench_keys("Short keys", [](size_t i) { return "user:" + std::to_string(i * 7919); });
+    bench_keys("URL keys", [](size_t i) {
+        std::string key = "https://example.com/static/assets/images/thumbnails/" + std::to_string(i);
+        return key + std::string(60 - key.size(), '/');
+    });
+
+    // Keys which all land in bucket 0 of a fnv1a_hash map with this many buckets
+    size_t bucket_count = prime_range_hash::bucket_count(N_FLOOD);
+    std::vector<std::string> flood;
+    fnv1a_hash fnv1a;
+    for(size_t i = 0; flood.size() < N_FLOOD; i++) {
+        std::string key = "user:" + std::to_string(i);
+        if(fnv1a(key) % bucket_count == 0)
+            flood.push_back(key);
+    }
+
+    std::cout << "Flooding keys, " << N_FLOOD << " inserts and finds into " << bucket_count << " buckets:" << std::endl;
+    bench<fnv1a_hash>("fnv1a", flood, std::numeric_limits<float>::infinity(), bucket_count);
+    bench<sip_hash>("sip", flood, std::numeric_limits<float>::infinity(), bucket_count);
+    bench<sip_hash>("sip, max chain 16", flood, std::numeric_limits<float>::infinity(), bucket_count, 16);
+
+    return 0;
+}
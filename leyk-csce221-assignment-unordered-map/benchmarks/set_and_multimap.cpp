@@ -0,0 +1,91 @@
+#include "UnorderedMultiMap.h"
+#include "UnorderedSet.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+    UnorderedSet and UnorderedMultiMap against their std counterparts on
+    the jobs they replace: a visited set filled and probed as a graph
+    search does (N_KEYS inserts of which about a third repeat, then
+    N_LOOKUPS membership tests), and a multimap of N_KEYS elements over
+    N_GROUPS keys read back one equal_range per key.
+*/
+
+constexpr size_t N_KEYS = 1 << 20;
+constexpr size_t N_LOOKUPS = 1 << 22;
+constexpr size_t N_GROUPS = 1 << 16;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Set>
+void visited_set(std::string const & name, std::vector<int> const & keys, std::vector<int> const & lookups) {
+    auto start = std::chrono::steady_clock::now();
+    Set set(0);
+    set.max_load_factor(1.0f);
+    for(int key : keys)
+        set.insert(key);
+    double build = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    size_t found = 0;
+    for(int key : lookups)
+        found += set.count(key);
+    double find = seconds_since(start);
+    std::cout << std::fixed << std::setprecision(3) << "  " << std::left << std::setw(24) << name << std::right
+              << std::setw(9) << build * 1e3 << " ms to insert, " << std::setw(9) << find * 1e3
+              << " ms to look up  (found: " << found << ")" << std::endl;
+}
+
+template<typename MultiMap>
+void grouped(std::string const & name, std::vector<int> const & keys) {
+    auto start = std::chrono::steady_clock::now();
+    MultiMap map(0);
+    map.max_load_factor(1.0f);
+    for(size_t i = 0; i < keys.size(); i++)
+        map.insert({keys[i], static_cast<int>(i)});
+    double build = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    long long sum = 0;
+    for(int key = 0; key < static_cast<int>(N_GROUPS); key++) {
+        auto range = map.equal_range(key);
+        for(auto it = range.first; it != range.second; ++it)
+            sum += it->second;
+    }
+    double read = seconds_since(start);
+    std::cout << "  " << std::left << std::setw(24) << name << std::right
+              << std::setw(9) << build * 1e3 << " ms to insert, " << std::setw(9) << read * 1e3
+              << " ms to read groups  (sum: " << sum << ")" << std::endl;
+}
+
+int main() {
+    std::mt19937 generator(221);
+    std::vector<int> keys;
+    for(size_t i = 0; i < N_KEYS; i++)
+        keys.push_back(static_cast<int>(generator() % (2 * N_KEYS)));
+    std::vector<int> lookups;
+    for(size_t i = 0; i < N_LOOKUPS; i++)
+        lookups.push_back(static_cast<int>(generator() % (2 * N_KEYS)));
+
+    std::cout << "Visited set, " << N_KEYS << " inserts, " << N_LOOKUPS << " lookups:" << std::endl;
+    visited_set<std::unordered_set<int>>("std::unordered_set", keys, lookups);
+    visited_set<UnorderedSet<int>>("UnorderedSet", keys, lookups);
+
+    std::vector<int> group_keys;
+    for(size_t i = 0; i < N_KEYS; i++)
+        group_keys.push_back(static_cast<int>(generator() % N_GROUPS));
+
+    std::cout << "Multimap, " << N_KEYS << " elements over " << N_GROUPS << " keys:" << std::endl;
+    grouped<std::unordered_multimap<int, int>>("std::unordered_multimap", group_keys);
+    grouped<UnorderedMultiMap<int, int>>("UnorderedMultiMap", group_keys);
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "FlatUnorderedMap.h"
+#include "UnorderedMap.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+    Iterating maps left sparse by erases. Each map gets N_KEYS keys, then
+    erases all but one in every KEEP_EVERY of them, keeping its bucket
+    array, and is walked begin() to end() N_ROUNDS times. UnorderedMap and
+    std::unordered_map walk their node lists, so the time follows the live
+    elements; FlatUnorderedMap walks its slots, skipping the empty ones a
+    group of control bytes at a time.
+*/
+
+constexpr size_t N_KEYS = 1 << 21;
+constexpr size_t N_ROUNDS = 20;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Map>
+void iterate(std::string const & name, size_t keep_every) {
+    Map map(N_KEYS);
+    for(size_t i = 0; i < N_KEYS; i++)
+        map.insert({static_cast<int>(i), static_cast<int>(i)});
+    for(size_t i = 0; i < N_KEYS; i++) {
+        if(i % keep_every != 0)
+            map.erase(static_cast<int>(i));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    long long sum = 0;
+    for(size_t round = 0; round < N_ROUNDS; round++) {
+        for(auto it = map.begin(); it != map.end(); ++it)
+            sum += it->second;
+    }
+    double walk = seconds_since(start) / N_ROUNDS;
+    std::cout << std::fixed << std::setprecision(3) << "  " << std::left << std::setw(24) << name << std::right
+              << std::setw(9) << walk * 1e3 << " ms per walk, " << std::setw(8) << map.size() << " of "
+              << map.bucket_count() << " buckets full  (sum: " << sum << ")" << std::endl;
+}
+
+int main() {
+    for(size_t keep_every : {1, 10, 100, 1000}) {
+        std::cout << "Keeping 1 in " << keep_every << " of " << N_KEYS << " keys:" << std::endl;
+        iterate<std::unordered_map<int, int>>("std::unordered_map", keep_every);
+        iterate<UnorderedMap<int, int>>("UnorderedMap", keep_every);
+        iterate<FlatUnorderedMap<int, int>>("FlatUnorderedMap", keep_every);
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "StaticUnorderedMap.h"
+#include "UnorderedMap.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+    Lookups in a table built once: the words of data_files, and N_KEYS
+    generated keys. Each is loaded into an UnorderedMap and into a
+    StaticUnorderedMap, and both serve the same N_LOOKUPS finds, half hits
+    and half misses. The static map's lookup is one slot and one key
+    comparison, hit or miss; the UnorderedMap walks a chain. Both use
+    std::hash, so only the table layout differs.
+*/
+
+constexpr size_t N_KEYS = 1 << 20;
+constexpr size_t N_LOOKUPS = 1 << 22;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void compare(std::string const & name, std::vector<std::string> const & keys, std::mt19937_64 & generator) {
+    std::vector<std::pair<std::string, int>> pairs;
+    for(size_t i = 0; i < keys.size(); i++)
+        pairs.emplace_back(keys[i], static_cast<int>(i));
+
+    // Misses differ from every key by a character no key contains
+    std::vector<std::string> lookups;
+    for(size_t i = 0; i < N_LOOKUPS; i++) {
+        lookups.push_back(keys[generator() % keys.size()]);
+        if(i % 2 == 1)
+            lookups.back() += '\x01';
+    }
+
+    std::cout << name << ": " << keys.size() << " keys, " << N_LOOKUPS << " finds" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    UnorderedMap<std::string, int> map(pairs.size());
+    for(auto const & pair : pairs)
+        map.insert(pair);
+    double build = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    size_t found = 0;
+    for(std::string const & key : lookups)
+        found += map.find(key) != map.end();
+    double find = seconds_since(start);
+    std::cout << std::fixed << std::setprecision(3)
+              << "  UnorderedMap:       " << std::setw(9) << build * 1e3 << " ms to build, "
+              << std::setw(9) << find * 1e3 << " ms to find  (found: " << found << ")" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    StaticUnorderedMap<std::string, int> table(pairs.begin(), pairs.end());
+    build = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    found = 0;
+    for(std::string const & key : lookups)
+        found += table.contains(key);
+    find = seconds_since(start);
+    std::cout << "  StaticUnorderedMap: " << std::setw(9) << build * 1e3 << " ms to build, "
+              << std::setw(9) << find * 1e3 << " ms to find  (found: " << found << ", "
+              << std::setprecision(2) << table.bits_per_key() << " bits/key of index)" << std::endl;
+}
+
+int main() {
+    std::mt19937_64 generator(221);
+
+    std::vector<std::string> words;
+    for(std::string path : {"../data_files/adjectives.txt", "../data_files/animals.txt"}) {
+        std::ifstream file(path);
+        std::string word;
+        while(file >> word)
+            words.push_back(word);
+    }
+    // Drop words which appear in both lists
+    UnorderedMap<std::string, int> unique(words.size());
+    for(std::string const & word : words)
+        unique.insert({word, 0});
+    words.clear();
+    for(auto it = unique.cbegin(); it != unique.cend(); it++)
+        words.push_back(it->first);
+    if(!words.empty())
+        compare("data_files words", words, generator);
+
+    std::vector<std::string> keys;
+    for(size_t i = 0; i < N_KEYS; i++)
+        keys.push_back("user:" + std::to_string(generator()));
+    compare("generated keys", keys, generator);
+    return 0;
+}
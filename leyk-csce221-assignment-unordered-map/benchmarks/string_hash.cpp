@@ -0,0 +1,63 @@
+#include "hash_functions.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+    Throughput of the string hashes in GB/s, hashing N_BYTES of key data
+    split into keys of each length. The keys sit back to back in one buffer
+    small enough for the cache, so this measures the hash and not memory.
+    wide_block_hash is run through operator() and through each path the CPU
+    supports.
+*/
+
+constexpr size_t N_BYTES = 1 << 28;
+constexpr size_t BUFFER_SIZE = 1 << 16;
+
+template<typename F>
+void bench(std::string const & name, std::string const & buffer, size_t len, F hash) {
+    size_t n_keys = BUFFER_SIZE / len;
+    size_t n_rounds = N_BYTES / (n_keys * len);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = 0;
+    for(size_t round = 0; round < n_rounds; round++)
+        for(size_t key = 0; key < n_keys; key++)
+            checksum += hash(std::string_view(buffer.data() + key * len, len));
+    auto stop = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    std::cout << std::setw(12) << name << ": " << std::fixed << std::setprecision(2)
+              << std::setw(6) << (n_rounds * n_keys * len / seconds) / 1e9 << " GB/s"
+              << "  (checksum: " << checksum % 1000 << ")" << std::endl;
+}
+
+int main() {
+    using isa = wide_block_hash::isa;
+
+    std::mt19937_64 generator(221);
+    std::string buffer(BUFFER_SIZE, 0);
+    for(char & c : buffer)
+        c = static_cast<char>(' ' + generator() % 95);
+
+    for(size_t len : {8ull, 16ull, 32ull, 64ull, 256ull, 4096ull}) {
+        std::cout << "Keys of " << len << " bytes:" << std::endl;
+        bench("fnv1a", buffer, len, fnv1a_hash{});
+        bench("polynomial", buffer, len, polynomial_rolling_hash{});
+        bench("wide_block", buffer, len, wide_block_hash{});
+        if(len > 32) {
+            std::pair<char const *, isa> paths[] = {{"  scalar", isa::scalar}, {"  sse2", isa::sse2}, {"  avx2", isa::avx2}};
+            for(auto [name, path] : paths)
+                if(wide_block_hash::supported(path))
+                    bench(name, buffer, len, [path = path](std::string_view str) { return wide_block_hash::hash(str, path); });
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <cstddef>      // size_t
+#include <cstdint>      // uint64_t
+#include <functional>   // std::hash
+#include <memory>       // std::unique_ptr, std::make_unique
+#include <mutex>        // std::unique_lock
+#include <optional>     // std::optional
+#include <shared_mutex> // std::shared_mutex, std::shared_lock
+#include <thread>       // std::thread::hardware_concurrency
+#include <utility>      // std::pair
+
+#include "UnorderedMap.h"
+
+/*
+ConcurrentUnorderedMap is an UnorderedMap which many threads can read and
+write at once. Keys are split over a power of two number of shards, each an
+UnorderedMap guarded by its own reader/writer lock. A key's shard comes from
+the high bits of its hash code after a 64-bit mix, so hashers with poor high
+bits (std::hash<int> is the identity) still spread over every shard, and the
+low bits the shard's own buckets use stay independent of the shard choice.
+
+Lookups take their shard's lock shared, so readers of one shard run in
+parallel; inserts, erases and updates take it exclusively. Threads only
+contend when they touch the same shard, and each shard grows on its own,
+under its own lock, without stopping the others.
+
+Nothing can point into a shard once its lock is released, so there are no
+iterators and find returns a copy of the value. Code which needs to read or
+change a value in place passes a function to visit or update, which runs
+under the lock.
+
+Example usage:
+
+#include "ConcurrentUnorderedMap.h"
+#include <thread>
+
+int main() {
+    ConcurrentUnorderedMap<int, int> counts;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&counts] {
+            for (int i = 0; i < 1000; i++) {
+                counts.try_emplace(i % 100, 0);
+                counts.update(i % 100, [](int &count) { count++; });
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    std::cout << *counts.find(42) << std::endl;   // 80
+    return 0;
+}
+
+Differences from UnorderedMap:
+
+- Every shard starts with a maximum load factor of 1.0, so the map grows as
+  it fills. rehash_step(n) makes the shards grow incrementally, which bounds
+  how long an insert holds its shard's lock.
+- The hasher runs twice per operation, once to pick the shard and once in
+  the shard's UnorderedMap.
+- size() and for_each lock one shard at a time, so while other threads write
+  they see each shard at a different moment.
+
+Big O Notation for operations:
+
+- Insert / Emplace / Find / Contains / Erase / Update / Visit:
+  - Description: Locks the key's shard and runs the UnorderedMap operation on it.
+  - Average case: O(1)
+  - Worst case: O(n) (when all elements hash to the same bucket)
+
+- Size / Clear / For each:
+  - Description: Locks each shard in turn.
+  - Complexity: O(shards) for size, O(n + shards) otherwise
+*/
+
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename Pred = std::equal_to<Key>,
+        typename RangeHash = prime_range_hash>
+class ConcurrentUnorderedMap {
+public:
+
+    using key_type = Key;
+    using mapped_type = T;
+    using hasher = Hash;
+    using key_equal = Pred;
+    using value_type = std::pair<const key_type, mapped_type>;
+    using size_type = size_t;
+    using shard_type = UnorderedMap<Key, T, Hash, Pred, RangeHash>;
+
+private:
+
+    // Shards are aligned to separate cache lines so a lock taken on one never slows down its neighbours
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        shard_type map;
+
+        Shard() : map(0) {}
+    };
+
+    size_type _shard_bits;
+    std::unique_ptr<Shard[]> _shards;
+    Hash _hash;
+
+    static size_type _default_shard_count() {
+        size_type threads = std::thread::hardware_concurrency();
+        return 4 * (threads == 0 ? 1 : threads);
+    }
+
+    // The code is mixed first, so the high bits taken for the shard depend on every bit of it
+    size_type _shard_of(size_type code) const {
+        return _shard_bits == 0 ? 0 : static_cast<size_type>(_mix_hash_code(code) >> (64 - _shard_bits));
+    }
+
+    Shard &_shard(const Key &key) const {
+        return _shards[_shard_of(_hash(key))];
+    }
+
+public:
+
+    /*
+        Splits the map over at least min_shards shards (rounded up to a
+        power of two, four per hardware thread by default), each starting
+        with bucket_count / shards buckets.
+    */
+    explicit ConcurrentUnorderedMap(size_type bucket_count = 0, size_type min_shards = _default_shard_count(),
+                                    const Hash &hash = Hash{}, const key_equal &equal = key_equal{})
+            : _shard_bits{0}, _hash{hash} {
+        while ((size_type{1} << _shard_bits) < min_shards && _shard_bits < 16) {
+            _shard_bits++;
+        }
+
+        size_type n_shards = shard_count();
+        _shards = std::make_unique<Shard[]>(n_shards);
+        for (size_type i = 0; i < n_shards; i++) {
+            _shards[i].map = shard_type(bucket_count / n_shards, hash, equal);
+            _shards[i].map.max_load_factor(1.0f);
+        }
+    }
+
+    ConcurrentUnorderedMap(const ConcurrentUnorderedMap &) = delete;
+
+    ConcurrentUnorderedMap &operator=(const ConcurrentUnorderedMap &) = delete;
+
+    size_type shard_count() const {
+        return size_type{1} << _shard_bits;
+    }
+
+    // Index of the shard which holds key
+    size_type shard(const Key &key) const {
+        return _shard_of(_hash(key));
+    }
+
+    // Number of elements. Exact only while no other thread writes.
+    size_type size() const {
+        size_type total = 0;
+        for (size_type i = 0; i < shard_count(); i++) {
+            std::shared_lock lock(_shards[i].mutex);
+            total += _shards[i].map.size();
+        }
+        return total;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    void clear() {
+        for (size_type i = 0; i < shard_count(); i++) {
+            std::unique_lock lock(_shards[i].mutex);
+            _shards[i].map.clear();
+        }
+    }
+
+    // Sets the maximum load factor of every shard, growing those which exceed it
+    void max_load_factor(float ml) {
+        for (size_type i = 0; i < shard_count(); i++) {
+            std::unique_lock lock(_shards[i].mutex);
+            _shards[i].map.max_load_factor(ml);
+        }
+    }
+
+    // Sets how many old buckets each insert migrates while a shard grows (see UnorderedMap::rehash_step)
+    void rehash_step(size_type step) {
+        for (size_type i = 0; i < shard_count(); i++) {
+            std::unique_lock lock(_shards[i].mutex);
+            _shards[i].map.rehash_step(step);
+        }
+    }
+
+    bool insert(const value_type &value) {
+        Shard &shard = _shard(value.first);
+        std::unique_lock lock(shard.mutex);
+        return shard.map.insert(value).second;
+    }
+
+    bool insert(value_type &&value) {
+        Shard &shard = _shard(value.first);
+        std::unique_lock lock(shard.mutex);
+        return shard.map.insert(std::move(value)).second;
+    }
+
+    // Inserts (key, T(args...)) if key is missing. Returns whether it did.
+    template<typename... Args>
+    bool try_emplace(const Key &key, Args &&... args) {
+        Shard &shard = _shard(key);
+        std::unique_lock lock(shard.mutex);
+        return shard.map.try_emplace(key, std::forward<Args>(args)...).second;
+    }
+
+    // Inserts (key, obj), or assigns obj to key's value. Returns whether key was inserted.
+    template<typename M>
+    bool insert_or_assign(const Key &key, M &&obj) {
+        Shard &shard = _shard(key);
+        std::unique_lock lock(shard.mutex);
+        return shard.map.insert_or_assign(key, std::forward<M>(obj)).second;
+    }
+
+    // A copy of key's value, or nothing if key is missing
+    std::optional<T> find(const Key &key) const {
+        Shard &shard = _shard(key);
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    bool contains(const Key &key) const {
+        Shard &shard = _shard(key);
+        std::shared_lock lock(shard.mutex);
+        return shard.map.contains(key);
+    }
+
+    size_type erase(const Key &key) {
+        Shard &shard = _shard(key);
+        std::unique_lock lock(shard.mutex);
+        return shard.map.erase(key);
+    }
+
+    /*
+        Calls fn(value) on key's value under the shard's exclusive lock, so
+        read-modify-write updates are atomic. Returns whether key was found.
+    */
+    template<typename F>
+    bool update(const Key &key, F fn) {
+        Shard &shard = _shard(key);
+        std::unique_lock lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            return false;
+        }
+        fn(it->second);
+        return true;
+    }
+
+    // Calls fn(value) on key's value under the shard's shared lock. Returns whether key was found.
+    template<typename F>
+    bool visit(const Key &key, F fn) const {
+        Shard &shard = _shard(key);
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            return false;
+        }
+        fn(static_cast<const T &>(it->second));
+        return true;
+    }
+
+    // Calls fn(key, value) for every element, holding each shard's shared lock while it is visited
+    template<typename F>
+    void for_each(F fn) const {
+        for (size_type i = 0; i < shard_count(); i++) {
+            std::shared_lock lock(_shards[i].mutex);
+            const shard_type &map = _shards[i].map;
+            for (auto it = map.cbegin(); it != map.cend(); it++) {
+                fn(it->first, static_cast<const T &>(it->second));
+            }
+        }
+    }
+};
@@ -0,0 +1,620 @@
+#pragma once
+
+#include <cstddef>    // size_t
+#include <cstdint>    // uint32_t
+#include <cstring>    // std::memset
+#include <functional> // std::hash
+#include <iterator>
+#include <new>        // placement new
+#include <stdexcept>  // std::invalid_argument
+#include <utility>    // std::pair
+
+#include "primes.h"
+#include "range_hash.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+FlatUnorderedMap is a drop-in sibling of UnorderedMap which stores every
+value_type inline in one contiguous array of slots instead of chaining
+separately allocated HashNodes off the buckets. Collisions are resolved with
+open addressing (linear probing) and each slot has a one byte "control" tag
+in a parallel array, in the spirit of SwissTable:
+
+    _EMPTY    - the slot has never held a value since the last rehash
+    _DELETED  - a tombstone; the slot was erased but probes must continue past it
+    0 .. 127  - the slot is full and holds the low 7 bits (h2) of its hash code
+
+A lookup hashes the key once, mixes the hash code with the MurmurHash3
+finalizer (range_hash.h), starts at slot (hash >> 7) % capacity and walks
+forward comparing control bytes. Only slots whose tag matches h2 have their key
+compared with key_equal, so nearly every probe is a one byte load from a dense
+array rather than a pointer chase.
+
+The control bytes double as the table's occupancy map. Iterators skip empty
+slots and tombstones 16 control bytes at a time (one SSE2 compare, or a
+plain loop where SSE2 is missing) and jump to the first full slot with a
+count of trailing zeros, so walking a table left sparse by many erases
+reads one byte per empty slot instead of branching on each.
+
+Example usage (identical to UnorderedMap):
+
+#include "FlatUnorderedMap.h"
+#include <iostream>
+
+int main() {
+    FlatUnorderedMap<int, std::string> map(5);
+
+    map.insert({1, "one"});
+    map.insert({2, "two"});
+    map[3] = "three";
+
+    map.erase(2);
+
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        std::cout << it->first << ": " << it->second << std::endl;
+    }
+
+    return 0;
+}
+
+Differences from UnorderedMap:
+
+- The table grows automatically once (size + tombstones) exceeds
+  max_load_factor() * bucket_count() (0.875 by default), since an open
+  addressed table cannot hold more values than it has slots. Growing moves
+  the values, so it invalidates iterators, pointers and references.
+- There are no per-bucket chains, so local iterators and bucket_size() are
+  not provided. bucket(key) returns the slot the probe for key starts at.
+
+Big O Notation for operations:
+
+- Insert / Find / Erase / operator[]:
+  - Average case: O(1)
+  - Worst case: O(n) (when all elements hash to the same slot)
+
+- Clear:
+  - Complexity: O(bucket_count)
+
+- Iterator increment:
+  - Average case: O(1)
+  - Worst case: O(bucket_count / 16) (when the table is nearly empty)
+*/
+
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename Pred = std::equal_to<Key>>
+class FlatUnorderedMap {
+public:
+
+    using key_type = Key;
+    using mapped_type = T;
+    using const_mapped_type = const T;
+    using hasher = Hash;
+    using key_equal = Pred;
+    using value_type = std::pair<const key_type, mapped_type>;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using pointer = value_type *;
+    using const_pointer = const value_type *;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+private:
+
+    using ctrl_t = signed char;
+
+    static constexpr ctrl_t _EMPTY = -128;
+    static constexpr ctrl_t _DELETED = -2;
+    static constexpr ctrl_t _SENTINEL = -1;
+
+    static constexpr float _DEFAULT_MAX_LOAD_FACTOR = 0.875f;
+
+    // Control bytes an iterator scans at once
+    static constexpr size_type _GROUP = 16;
+
+    /*
+        Raw storage for one value. The union keeps the value from being
+        constructed or destroyed with the array; the control byte decides
+        whether val is alive.
+    */
+    union Slot {
+        value_type val;
+
+        Slot() {}
+
+        ~Slot() {}
+    };
+
+    size_type _capacity;
+    ctrl_t *_ctrl;
+    Slot *_slots;
+
+    size_type _size;
+    size_type _tombstones;
+    float _max_load_factor;
+
+    Hash _hash;
+    key_equal _equal;
+
+    static bool _is_full(ctrl_t ctrl) {
+        return ctrl >= 0;
+    }
+
+    /*
+        Returns a mask with bit i set when ctrl[i] is full or the sentinel,
+        for the _GROUP control bytes from ctrl on.
+    */
+    static uint32_t _stops(const ctrl_t *ctrl) {
+#if defined(__SSE2__)
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+        uint32_t full = ~static_cast<uint32_t>(_mm_movemask_epi8(group)) & 0xFFFF;
+        uint32_t sentinel = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(_SENTINEL))));
+        return full | sentinel;
+#else
+        uint32_t stops = 0;
+        for (size_type index = 0; index < _GROUP; index++) {
+            if (_is_full(ctrl[index]) || ctrl[index] == _SENTINEL) {
+                stops |= uint32_t{1} << index;
+            }
+        }
+        return stops;
+#endif
+    }
+
+    static ctrl_t _h2(size_type hash_code) {
+        return static_cast<ctrl_t>(hash_code & 0x7F);
+    }
+
+    static size_type _range_hash(size_type hash_code, size_type bucket_count) {
+        return (hash_code >> 7) % bucket_count;
+    }
+
+    /*
+        The hash code of key, mixed so that both the tag (the low 7 bits) and
+        the home slot depend on every bit. Without it std::hash<int>, the
+        identity, gives 128 consecutive keys one home slot and one tag, and
+        sequential keys pile into a single probe run.
+    */
+    size_type _code(const Key &key) const {
+        return static_cast<size_type>(_mix_hash_code(_hash(key)));
+    }
+
+public:
+
+    template<typename pointer_type, typename reference_type, typename _value_type>
+    class basic_iterator {
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = _value_type;
+        using difference_type = ptrdiff_t;
+        using pointer = value_type *;
+        using reference = value_type &;
+
+    private:
+        friend class FlatUnorderedMap;
+
+        using Slot = typename FlatUnorderedMap::Slot;
+
+        const ctrl_t *_ctrl;
+        Slot *_slot;
+
+        explicit basic_iterator(const ctrl_t *ctrl, Slot *slot) noexcept : _ctrl{ctrl}, _slot{slot} {}
+
+        /*
+            Walks forward to the next full slot, a group at a time once the
+            next slot is not full. The sentinel after the last slot stops
+            the scan.
+        */
+        void _skip_empty() {
+            if (_is_full(*_ctrl)) {
+                return;
+            }
+            uint32_t stops = _stops(_ctrl);
+            while (stops == 0) {
+                _ctrl += _GROUP;
+                _slot += _GROUP;
+                stops = _stops(_ctrl);
+            }
+            _ctrl += __builtin_ctz(stops);
+            _slot += __builtin_ctz(stops);
+        }
+
+    public:
+        basic_iterator() : _ctrl{nullptr}, _slot{nullptr} {}
+
+        basic_iterator(const basic_iterator &) = default;
+
+        basic_iterator(basic_iterator &&) = default;
+
+        ~basic_iterator() = default;
+
+        basic_iterator &operator=(const basic_iterator &) = default;
+
+        basic_iterator &operator=(basic_iterator &&) = default;
+
+        reference operator*() const { return _slot->val; }
+
+        pointer operator->() const { return &(_slot->val); }
+
+        basic_iterator &operator++() {
+            _ctrl++;
+            _slot++;
+            _skip_empty();
+            return *this;
+        }
+
+        basic_iterator operator++(int) {
+            basic_iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        bool operator==(const basic_iterator &other) const noexcept {
+            return this->_ctrl == other._ctrl;
+        }
+
+        bool operator!=(const basic_iterator &other) const noexcept {
+            return this->_ctrl != other._ctrl;
+        }
+    };
+
+    using iterator = basic_iterator<pointer, reference, value_type>;
+    using const_iterator = basic_iterator<const_pointer, const_reference, const value_type>;
+
+private:
+
+    /*
+        Allocates an all-empty table of bucket_count slots. The control bytes
+        are followed by _GROUP sentinels: the first terminates iteration, and
+        the rest let an iterator load a whole group from any slot.
+    */
+    void _allocate(size_type bucket_count) {
+        _capacity = bucket_count;
+        _ctrl = new ctrl_t[_capacity + _GROUP];
+        std::memset(_ctrl, _EMPTY, _capacity);
+        std::memset(_ctrl + _capacity, _SENTINEL, _GROUP);
+        _slots = new Slot[_capacity];
+        _size = 0;
+        _tombstones = 0;
+    }
+
+    void _destroy_values() noexcept {
+        if (_size == 0) {
+            return;
+        }
+        for (size_type index = 0; index < _capacity; index++) {
+            if (_is_full(_ctrl[index])) {
+                _slots[index].val.~value_type();
+            }
+        }
+    }
+
+    void _deallocate() noexcept {
+        delete[] _ctrl;
+        delete[] _slots;
+        _ctrl = nullptr;
+        _slots = nullptr;
+        _capacity = 0;
+    }
+
+    size_type _next_slot(size_type index) const {
+        return index + 1 == _capacity ? 0 : index + 1;
+    }
+
+    /*
+        Returns the slot holding key, or _capacity if it is absent.
+    */
+    size_type _find(size_type code, const Key &key) const {
+        ctrl_t tag = _h2(code);
+        size_type index = _range_hash(code, _capacity);
+
+        while (_ctrl[index] != _EMPTY) {
+            if (_ctrl[index] == tag && _equal(_slots[index].val.first, key)) {
+                return index;
+            }
+            index = _next_slot(index);
+        }
+        return _capacity;
+    }
+
+    /*
+        Returns the slot a new key with hash code should be stored in: the first
+        tombstone on its probe sequence, or the empty slot which ends it.
+    */
+    size_type _find_insert_slot(size_type code) const {
+        size_type index = _range_hash(code, _capacity);
+
+        while (_is_full(_ctrl[index])) {
+            index = _next_slot(index);
+        }
+        return index;
+    }
+
+    bool _needs_growth() const {
+        return static_cast<float>(_size + _tombstones + 1) > _max_load_factor * _capacity
+               || _size + _tombstones + 1 >= _capacity;
+    }
+
+    /*
+        Grows the table if one more value would exceed the load factor. When
+        most of the occupied slots are tombstones, this rebuilds the table at
+        about the same size, which clears them out.
+    */
+    void _grow_if_needed() {
+        if (_needs_growth()) {
+            _rehash(_grown_bucket_count(_size + 1));
+        }
+    }
+
+    size_type _grown_bucket_count(size_type count) const {
+        return next_greater_prime(static_cast<size_type>(2 * count / _max_load_factor) + 1);
+    }
+
+    template<typename... Args>
+    size_type _construct_at(size_type code, Args &&... args) {
+        size_type index = _find_insert_slot(code);
+        new(&_slots[index].val) value_type(std::forward<Args>(args)...);
+        if (_ctrl[index] == _DELETED) {
+            _tombstones--;
+        }
+        _ctrl[index] = _h2(code);
+        _size++;
+        return index;
+    }
+
+    /*
+        Moves every value into a fresh table of bucket_count slots. value_type
+        has a const key, so the key is moved out through a const_cast; the
+        source value is destroyed immediately afterwards and never observed.
+    */
+    void _rehash(size_type bucket_count) {
+        ctrl_t *oldCtrl = _ctrl;
+        Slot *oldSlots = _slots;
+        size_type oldCapacity = _capacity;
+
+        _allocate(bucket_count);
+
+        for (size_type index = 0; index < oldCapacity; index++) {
+            if (_is_full(oldCtrl[index])) {
+                value_type &val = oldSlots[index].val;
+                _construct_at(_code(val.first), std::move(const_cast<key_type &>(val.first)),
+                              std::move(val.second));
+                val.~value_type();
+            }
+        }
+
+        delete[] oldCtrl;
+        delete[] oldSlots;
+    }
+
+    /*
+        Removes the value in slot index. If the next slot is empty no probe
+        sequence continues through this slot, so it can be marked empty
+        instead of leaving a tombstone.
+    */
+    void _erase_slot(size_type index) {
+        _slots[index].val.~value_type();
+        if (_ctrl[_next_slot(index)] == _EMPTY) {
+            _ctrl[index] = _EMPTY;
+        } else {
+            _ctrl[index] = _DELETED;
+            _tombstones++;
+        }
+        _size--;
+    }
+
+    void _copy_content(const FlatUnorderedMap &other) {
+        _allocate(other._capacity);
+        for (size_type index = 0; index <= _capacity; index++) {
+            _ctrl[index] = other._ctrl[index];
+        }
+        for (size_type index = 0; index < _capacity; index++) {
+            if (_is_full(_ctrl[index])) {
+                new(&_slots[index].val) value_type(other._slots[index].val);
+            }
+        }
+        _size = other._size;
+        _tombstones = other._tombstones;
+        _max_load_factor = other._max_load_factor;
+    }
+
+    void _move_content(FlatUnorderedMap &src, FlatUnorderedMap &dst) {
+        dst._hash = std::move(src._hash);
+        dst._equal = std::move(src._equal);
+        dst._capacity = src._capacity;
+        dst._ctrl = src._ctrl;
+        dst._slots = src._slots;
+        dst._size = src._size;
+        dst._tombstones = src._tombstones;
+        dst._max_load_factor = src._max_load_factor;
+        src._allocate(src._capacity);
+    }
+
+    iterator _iterator_at(size_type index) {
+        return iterator(_ctrl + index, _slots + index);
+    }
+
+public:
+    explicit FlatUnorderedMap(size_type bucket_count, const Hash &hash = Hash{},
+                              const key_equal &equal = key_equal{})
+            : _max_load_factor{_DEFAULT_MAX_LOAD_FACTOR}, _hash{hash}, _equal{equal} {
+        _allocate(next_greater_prime(bucket_count));
+    }
+
+    ~FlatUnorderedMap() {
+        _destroy_values();
+        _deallocate();
+        _size = 0;
+    }
+
+    FlatUnorderedMap(const FlatUnorderedMap &other) : _hash{other._hash}, _equal{other._equal} {
+        _copy_content(other);
+    }
+
+    FlatUnorderedMap(FlatUnorderedMap &&other) : _hash{other._hash}, _equal{other._equal} {
+        _move_content(other, *this);
+    }
+
+    FlatUnorderedMap &operator=(const FlatUnorderedMap &other) {
+        if (this != &other) {
+            _destroy_values();
+            _deallocate();
+            _hash = other._hash;
+            _equal = other._equal;
+            _copy_content(other);
+        }
+        return *this;
+    }
+
+    FlatUnorderedMap &operator=(FlatUnorderedMap &&other) {
+        if (this != &other) {
+            _destroy_values();
+            _deallocate();
+            _move_content(other, *this);
+        }
+        return *this;
+    }
+
+    void clear() noexcept {
+        _destroy_values();
+        for (size_type index = 0; index < _capacity; index++) {
+            _ctrl[index] = _EMPTY;
+        }
+        _size = 0;
+        _tombstones = 0;
+    }
+
+    size_type size() const noexcept {
+        return _size;
+    }
+
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+
+    size_type bucket_count() const noexcept {
+        return _capacity;
+    }
+
+    iterator begin() {
+        iterator it(_ctrl, _slots);
+        it._skip_empty();
+        return it;
+    }
+
+    iterator end() {
+        return _iterator_at(_capacity);
+    }
+
+    const_iterator cbegin() const {
+        const_iterator it(_ctrl, _slots);
+        it._skip_empty();
+        return it;
+    }
+
+    const_iterator cend() const {
+        return const_iterator(_ctrl + _capacity, _slots + _capacity);
+    }
+
+    float load_factor() const {
+        return ((float) _size) / _capacity;
+    }
+
+    float max_load_factor() const {
+        return _max_load_factor;
+    }
+
+    /*
+        Sets the maximum ratio of occupied slots (values and tombstones) to
+        slots. Values above 1 are clamped since every value needs a slot;
+        zero, negative values and NaN throw std::invalid_argument.
+    */
+    void max_load_factor(float ml) {
+        if (!(ml > 0.0f)) {
+            throw std::invalid_argument("max_load_factor must be positive");
+        }
+        _max_load_factor = ml > 1.0f ? 1.0f : ml;
+        if (_needs_growth()) {
+            _rehash(_grown_bucket_count(_size));
+        }
+    }
+
+    /*
+        Rebuilds the table with at least count slots (more if the current
+        values would exceed the maximum load factor).
+    */
+    void rehash(size_type count) {
+        size_type minimum = static_cast<size_type>(_size / _max_load_factor) + 1;
+        _rehash(next_greater_prime(count > minimum ? count : minimum));
+    }
+
+    void reserve(size_type count) {
+        rehash(static_cast<size_type>(count / _max_load_factor) + 1);
+    }
+
+    size_type bucket(const Key &key) const {
+        return _range_hash(_code(key), _capacity);
+    }
+
+    std::pair<iterator, bool> insert(value_type &&value) {
+        size_type code = _code(value.first);
+        size_type index = _find(code, value.first);
+
+        if (index != _capacity) {
+            return std::make_pair(_iterator_at(index), false);
+        }
+        _grow_if_needed();
+        return std::make_pair(_iterator_at(_construct_at(code, std::move(value))), true);
+    }
+
+    std::pair<iterator, bool> insert(const value_type &value) {
+        size_type code = _code(value.first);
+        size_type index = _find(code, value.first);
+
+        if (index != _capacity) {
+            return std::make_pair(_iterator_at(index), false);
+        }
+        _grow_if_needed();
+        return std::make_pair(_iterator_at(_construct_at(code, value)), true);
+    }
+
+    iterator find(const Key &key) {
+        return _iterator_at(_find(_code(key), key));
+    }
+
+    T &operator[](const Key &key) {
+        size_type code = _code(key);
+        size_type index = _find(code, key);
+
+        if (index == _capacity) {
+            _grow_if_needed();
+            index = _construct_at(code, key, T{});
+        }
+        return _slots[index].val.second;
+    }
+
+    iterator erase(iterator pos) {
+        if (pos == end()) {
+            return end();
+        }
+
+        size_type index = pos._ctrl - _ctrl;
+        _erase_slot(index);
+
+        iterator it = _iterator_at(index);
+        ++it;
+        return it;
+    }
+
+    size_type erase(const Key &key) {
+        size_type index = _find(_code(key), key);
+
+        if (index == _capacity) {
+            return 0;
+        }
+        _erase_slot(index);
+        return 1;
+    }
+};
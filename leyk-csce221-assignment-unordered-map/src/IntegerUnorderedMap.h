@@ -0,0 +1,716 @@
+#pragma once
+
+#include <cstddef>     // size_t
+#include <cstdint>     // uint32_t, uint64_t
+#include <cstring>     // std::memcpy, std::memset
+#include <iterator>    // std::forward_iterator_tag
+#include <new>         // placement new
+#include <stdexcept>   // std::out_of_range
+#include <type_traits> // std::is_integral, std::make_unsigned_t, std::conditional_t
+#include <utility>     // std::pair
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+IntegerUnorderedMap is a map for integer keys, such as the IDs of an ID
+remapping table, where UnorderedMap spends a node header, an allocation and
+a bucket pointer on every few bytes of payload. It keeps keys and values in
+two parallel arrays (structure of arrays), so a probe reads nothing but
+keys, and an entry costs sizeof(Key) + sizeof(T) bytes divided by the load
+factor: 9 to 14 bytes for int keys and values, against about 40 for
+UnorderedMap<int, int>. bytes_per_entry() reports it.
+
+Collisions are resolved with linear probing. Key 0 marks an empty slot, so
+the key array alone tells which slots are full; key 0 itself is kept in one
+extra value slot outside the table. A lookup compares the key with 32 bytes
+of keys at once (8 int keys, 4 uint64_t keys) using SSE2, or with a plain
+loop where SSE2 is missing, and stops at the first empty slot. Erasing
+shifts the later keys of the run back over the hole rather than leaving a
+tombstone, so probe runs never carry dead slots.
+
+std::hash of an integer is the identity, so keys which are close together,
+as IDs are, would land in neighbouring slots and merge into long runs. The
+map hashes keys itself, with Fibonacci hashing: the key is multiplied by
+2^64 / golden ratio, which spreads every key bit over the high bits, and
+the high bits are scaled onto the table size with a multiply-high, which
+works for any size, not only powers of two.
+
+Probing does not wrap around. The table has capacity home slots followed by
+an overflow area of capacity / 32 + 8 slots where runs from the last home
+slots spill over; should a run ever reach the end of that area, the table
+grows. Growing multiplies the capacity by 1.5 rather than 2, which keeps
+the load factor between about 0.58 and 0.875 and the memory per entry low.
+
+Differences from UnorderedMap:
+
+- Key must be an integer type of at most 8 bytes. There is no Hash or Pred.
+- Values live in the table, so growing, and erasing (which shifts later
+  values back), invalidate iterators, pointers and references.
+- Iterators give std::pair<const Key, T &> by value, since no pair is
+  stored; it->first and it->second work as usual.
+- There are no buckets to iterate, no node handles and no allocator.
+
+Example usage:
+
+#include "IntegerUnorderedMap.h"
+#include <iostream>
+
+int main() {
+    IntegerUnorderedMap<uint64_t, uint32_t> remap(1000);
+
+    for (uint64_t id: {900001ull, 900007ull, 900001ull, 42ull}) {
+        remap.try_emplace(id, static_cast<uint32_t>(remap.size()));
+    }
+    std::cout << remap.at(900007) << " " << remap.size() << std::endl;   // 1 3
+    std::cout << remap.contains(5) << std::endl;                          // 0
+    return 0;
+}
+
+Big O Notation for operations:
+
+- Insert / Try emplace / Find / Contains / At / operator[] / Erase:
+  - Average case: O(1)
+  - Worst case: O(n) (when all keys land in one run)
+
+- Clear:
+  - Complexity: O(bucket_count)
+
+- Rehash / Reserve / Growth:
+  - Complexity: O(n + bucket_count)
+
+- Iterator increment:
+  - Average case: O(1)
+  - Worst case: O(bucket_count) (when the table is nearly empty)
+
+benchmarks/integer_map.cpp compares it with UnorderedMap and
+std::unordered_map.
+*/
+
+template<typename Key, typename T>
+class IntegerUnorderedMap {
+    static_assert(std::is_integral<Key>::value && !std::is_same<Key, bool>::value && sizeof(Key) <= 8,
+                  "IntegerUnorderedMap needs an integer key of at most 8 bytes");
+
+public:
+
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+private:
+
+    static constexpr Key _EMPTY = 0;
+
+    // Keys compared per probe step: 32 bytes of them
+    static constexpr size_type _GROUP = 32 / sizeof(Key);
+
+    static constexpr float _DEFAULT_MAX_LOAD_FACTOR = 0.875f;
+    static constexpr float _MAX_MAX_LOAD_FACTOR = 0.95f;
+
+    // Raw storage for one value; the key array decides whether val is alive
+    union Slot {
+        T val;
+
+        Slot() {}
+
+        ~Slot() {}
+    };
+
+    /*
+        _keys holds the _capacity home slots, the overflow area after them
+        (together _slot_count slots) and then _GROUP always empty keys, so a
+        probe may read a whole group anywhere in the table. _values has a
+        value for each of the _slot_count slots and one more for key 0.
+    */
+    size_type _capacity;
+    size_type _slot_count;
+    Key *_keys;
+    Slot *_values;
+
+    bool _has_zero;
+    size_type _size;
+    float _max_load_factor;
+
+    static size_type _overflow(size_type capacity) {
+        return capacity / 32 + 8;
+    }
+
+    size_type _home(Key key) const {
+        __extension__ typedef unsigned __int128 uint128;
+        uint64_t mixed = static_cast<uint64_t>(static_cast<std::make_unsigned_t<Key>>(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_type>((static_cast<uint128>(mixed) * _capacity) >> 64);
+    }
+
+    static void _prefetch(const void *address) {
+#if defined(__GNUC__)
+        __builtin_prefetch(address);
+#else
+        (void) address;
+#endif
+    }
+
+#if defined(__SSE2__)
+    static __m128i _splat(Key key) {
+        if constexpr (sizeof(Key) == 1) {
+            return _mm_set1_epi8(static_cast<char>(key));
+        } else if constexpr (sizeof(Key) == 2) {
+            return _mm_set1_epi16(static_cast<short>(key));
+        } else if constexpr (sizeof(Key) == 4) {
+            return _mm_set1_epi32(static_cast<int>(key));
+        } else {
+            return _mm_set1_epi64x(static_cast<long long>(key));
+        }
+    }
+
+    // SSE2 has no 64-bit compare, so 8-byte lanes are equal when both of their 4-byte halves are
+    static __m128i _equal(__m128i a, __m128i b) {
+        if constexpr (sizeof(Key) == 1) {
+            return _mm_cmpeq_epi8(a, b);
+        } else if constexpr (sizeof(Key) == 2) {
+            return _mm_cmpeq_epi16(a, b);
+        } else if constexpr (sizeof(Key) == 4) {
+            return _mm_cmpeq_epi32(a, b);
+        } else {
+            __m128i halves = _mm_cmpeq_epi32(a, b);
+            return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+    }
+#endif
+
+    /*
+        Compares the _GROUP keys from group on with key and with the empty
+        key. Bit b of matches (empties) is set when byte b of the group
+        belongs to a key equal to key (empty), so the index of a key in the
+        group is the number of its lowest bit divided by sizeof(Key).
+    */
+    static void _match(const Key *group, Key key, uint32_t &matches, uint32_t &empties) {
+#if defined(__SSE2__)
+        const __m128i *vectors = reinterpret_cast<const __m128i *>(group);
+        __m128i low = _mm_loadu_si128(vectors);
+        __m128i high = _mm_loadu_si128(vectors + 1);
+        __m128i needle = _splat(key);
+        __m128i zero = _mm_setzero_si128();
+        matches = static_cast<uint32_t>(_mm_movemask_epi8(_equal(low, needle)))
+                  | static_cast<uint32_t>(_mm_movemask_epi8(_equal(high, needle))) << 16;
+        empties = static_cast<uint32_t>(_mm_movemask_epi8(_equal(low, zero)))
+                  | static_cast<uint32_t>(_mm_movemask_epi8(_equal(high, zero))) << 16;
+#else
+        constexpr uint32_t lane = (uint32_t{1} << sizeof(Key)) - 1;
+        matches = 0;
+        empties = 0;
+        for (size_type index = 0; index < _GROUP; index++) {
+            if (group[index] == key) {
+                matches |= lane << (index * sizeof(Key));
+            }
+            if (group[index] == _EMPTY) {
+                empties |= lane << (index * sizeof(Key));
+            }
+        }
+#endif
+    }
+
+    /*
+        Probes for key, which is not 0. Returns its slot and sets found, or
+        returns the empty slot which ends its run, where it would go. Keys
+        of a run sit before the run's first empty slot, so a match after
+        that slot is ignored.
+    */
+    size_type _probe(Key key, bool &found) const {
+        for (size_type index = _home(key);; index += _GROUP) {
+            uint32_t matches;
+            uint32_t empties;
+            _match(_keys + index, key, matches, empties);
+            uint32_t beforeEmpty = empties == 0 ? ~uint32_t{0} : (empties & (0 - empties)) - 1;
+            if ((matches & beforeEmpty) != 0) {
+                found = true;
+                return index + __builtin_ctz(matches & beforeEmpty) / sizeof(Key);
+            }
+            if (empties != 0) {
+                found = false;
+                return index + __builtin_ctz(empties) / sizeof(Key);
+            }
+        }
+    }
+
+    /*
+        Slot of key, or _slot_count + 1 (the end) if it is absent. A key is
+        nearly always within a slot or two of its home, so the value line
+        at home is fetched while the keys are compared, and a hit does not
+        wait for a second cache miss after the first.
+    */
+    size_type _find(Key key) const {
+        if (key == _EMPTY) {
+            return _has_zero ? _slot_count : _slot_count + 1;
+        }
+        _prefetch(_values + _home(key));
+        bool found;
+        size_type index = _probe(key, found);
+        return found ? index : _slot_count + 1;
+    }
+
+    void _allocate(size_type capacity) {
+        _capacity = capacity;
+        _slot_count = capacity + _overflow(capacity);
+        _keys = new Key[_slot_count + _GROUP];
+        std::memset(_keys, 0, (_slot_count + _GROUP) * sizeof(Key));
+        _values = new Slot[_slot_count + 1];
+        _has_zero = false;
+        _size = 0;
+    }
+
+    void _destroy_values() noexcept {
+        if (_size == 0) {
+            return;
+        }
+        for (size_type index = 0; index < _slot_count; index++) {
+            if (_keys[index] != _EMPTY) {
+                _values[index].val.~T();
+            }
+        }
+        if (_has_zero) {
+            _values[_slot_count].val.~T();
+        }
+    }
+
+    void _deallocate() noexcept {
+        delete[] _keys;
+        delete[] _values;
+        _keys = nullptr;
+        _values = nullptr;
+        _capacity = 0;
+        _slot_count = 0;
+    }
+
+    // Whether one more key would take the home slots past the maximum load factor
+    bool _needs_growth() const {
+        return static_cast<float>(_size - _has_zero + 1) > _max_load_factor * _capacity;
+    }
+
+    size_type _grown_capacity(size_type count) const {
+        return static_cast<size_type>(count / _max_load_factor * 1.5f) + 1;
+    }
+
+    /*
+        Moves every value into a fresh table of at least capacity home slots.
+        Should a run overflow the new table, which all but never happens,
+        the values moved so far go back and a larger table is tried.
+    */
+    void _rehash(size_type capacity) {
+        Key *oldKeys = _keys;
+        Slot *oldValues = _values;
+        size_type oldSlotCount = _slot_count;
+        bool hadZero = _has_zero;
+        size_type size = _size;
+
+        for (;;) {
+            _allocate(capacity);
+            size_type index = 0;
+            for (; index < oldSlotCount; index++) {
+                if (oldKeys[index] == _EMPTY) {
+                    continue;
+                }
+                bool found;
+                size_type slot = _probe(oldKeys[index], found);
+                if (slot >= _slot_count) {
+                    break;
+                }
+                new(&_values[slot].val) T(std::move(oldValues[index].val));
+                oldValues[index].val.~T();
+                _keys[slot] = oldKeys[index];
+            }
+            if (index == oldSlotCount) {
+                break;
+            }
+
+            for (size_type moved = 0; moved < index; moved++) {
+                if (oldKeys[moved] != _EMPTY) {
+                    bool found;
+                    size_type slot = _probe(oldKeys[moved], found);
+                    new(&oldValues[moved].val) T(std::move(_values[slot].val));
+                    _values[slot].val.~T();
+                }
+            }
+            _deallocate();
+            capacity += capacity / 2 + 1;
+        }
+
+        if (hadZero) {
+            new(&_values[_slot_count].val) T(std::move(oldValues[oldSlotCount].val));
+            oldValues[oldSlotCount].val.~T();
+        }
+        _has_zero = hadZero;
+        _size = size;
+
+        delete[] oldKeys;
+        delete[] oldValues;
+    }
+
+    /*
+        Empties slot index by shifting back, over the hole, each later key
+        of the run whose home is at or before the hole. Keys only move
+        towards the front, so an iteration past index sees every remaining
+        key once.
+    */
+    void _erase_slot(size_type index) {
+        if (index == _slot_count) {
+            _values[index].val.~T();
+            _has_zero = false;
+            _size--;
+            return;
+        }
+
+        _values[index].val.~T();
+        size_type hole = index;
+        for (size_type next = index + 1; _keys[next] != _EMPTY; next++) {
+            if (_home(_keys[next]) <= hole) {
+                new(&_values[hole].val) T(std::move(_values[next].val));
+                _values[next].val.~T();
+                _keys[hole] = _keys[next];
+                hole = next;
+            }
+        }
+        _keys[hole] = _EMPTY;
+        _size--;
+    }
+
+    void _copy_content(const IntegerUnorderedMap &other) {
+        _allocate(other._capacity);
+        std::memcpy(_keys, other._keys, (_slot_count + _GROUP) * sizeof(Key));
+        for (size_type index = 0; index < _slot_count; index++) {
+            if (_keys[index] != _EMPTY) {
+                new(&_values[index].val) T(other._values[index].val);
+            }
+        }
+        if (other._has_zero) {
+            new(&_values[_slot_count].val) T(other._values[_slot_count].val);
+        }
+        _has_zero = other._has_zero;
+        _size = other._size;
+        _max_load_factor = other._max_load_factor;
+    }
+
+    void _move_content(IntegerUnorderedMap &src, IntegerUnorderedMap &dst) {
+        dst._capacity = src._capacity;
+        dst._slot_count = src._slot_count;
+        dst._keys = src._keys;
+        dst._values = src._values;
+        dst._has_zero = src._has_zero;
+        dst._size = src._size;
+        dst._max_load_factor = src._max_load_factor;
+        src._allocate(1);
+    }
+
+    template<typename... Args>
+    std::pair<size_type, bool> _try_emplace(Key key, Args &&... args) {
+        if (key == _EMPTY) {
+            if (_has_zero) {
+                return {_slot_count, false};
+            }
+            new(&_values[_slot_count].val) T(std::forward<Args>(args)...);
+            _has_zero = true;
+            _size++;
+            return {_slot_count, true};
+        }
+
+        bool found;
+        size_type index = _probe(key, found);
+        if (found) {
+            return {index, false};
+        }
+        if (_needs_growth()) {
+            _rehash(_grown_capacity(_size - _has_zero + 1));
+            index = _probe(key, found);
+        }
+        while (index >= _slot_count) {
+            _rehash(_capacity + _capacity / 2 + 1);
+            index = _probe(key, found);
+        }
+
+        new(&_values[index].val) T(std::forward<Args>(args)...);
+        _keys[index] = key;
+        _size++;
+        return {index, true};
+    }
+
+public:
+
+    template<bool Const>
+    class basic_iterator {
+        using map_pointer = std::conditional_t<Const, const IntegerUnorderedMap *, IntegerUnorderedMap *>;
+        using mapped_reference = std::conditional_t<Const, const T &, T &>;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename IntegerUnorderedMap::value_type;
+        using difference_type = ptrdiff_t;
+        using reference = std::pair<const Key, mapped_reference>;
+
+        // What operator-> returns: the pair of key and value reference, kept alive for the expression
+        struct pointer {
+            reference pair;
+
+            reference *operator->() {
+                return &pair;
+            }
+        };
+
+    private:
+        friend class IntegerUnorderedMap;
+
+        map_pointer _map;
+        size_type _index;
+
+        basic_iterator(map_pointer map, size_type index) : _map{map}, _index{index} {}
+
+        // Walks forward to the next full slot, then to key 0's slot, then to the end
+        void _skip_empty() {
+            while (_index < _map->_slot_count && _map->_keys[_index] == _EMPTY) {
+                _index++;
+            }
+            if (_index == _map->_slot_count && !_map->_has_zero) {
+                _index++;
+            }
+        }
+
+    public:
+        basic_iterator() : _map{nullptr}, _index{0} {}
+
+        // An iterator converts to a const_iterator
+        template<bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+        basic_iterator(const basic_iterator<OtherConst> &other) : _map{other._map}, _index{other._index} {}
+
+        reference operator*() const {
+            Key key = _index == _map->_slot_count ? _EMPTY : _map->_keys[_index];
+            return reference(key, _map->_values[_index].val);
+        }
+
+        pointer operator->() const {
+            return pointer{**this};
+        }
+
+        basic_iterator &operator++() {
+            _index++;
+            _skip_empty();
+            return *this;
+        }
+
+        basic_iterator operator++(int) {
+            basic_iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        bool operator==(const basic_iterator &other) const noexcept {
+            return _index == other._index;
+        }
+
+        bool operator!=(const basic_iterator &other) const noexcept {
+            return _index != other._index;
+        }
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    explicit IntegerUnorderedMap(size_type bucket_count) : _max_load_factor{_DEFAULT_MAX_LOAD_FACTOR} {
+        _allocate(bucket_count > 0 ? bucket_count : 1);
+    }
+
+    ~IntegerUnorderedMap() {
+        _destroy_values();
+        _deallocate();
+        _size = 0;
+    }
+
+    IntegerUnorderedMap(const IntegerUnorderedMap &other) {
+        _copy_content(other);
+    }
+
+    IntegerUnorderedMap(IntegerUnorderedMap &&other) {
+        _move_content(other, *this);
+    }
+
+    IntegerUnorderedMap &operator=(const IntegerUnorderedMap &other) {
+        if (this != &other) {
+            _destroy_values();
+            _deallocate();
+            _copy_content(other);
+        }
+        return *this;
+    }
+
+    IntegerUnorderedMap &operator=(IntegerUnorderedMap &&other) {
+        if (this != &other) {
+            _destroy_values();
+            _deallocate();
+            _move_content(other, *this);
+        }
+        return *this;
+    }
+
+    void clear() noexcept {
+        _destroy_values();
+        std::memset(_keys, 0, _slot_count * sizeof(Key));
+        _has_zero = false;
+        _size = 0;
+    }
+
+    size_type size() const noexcept {
+        return _size;
+    }
+
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+
+    // The number of home slots; the overflow area is not counted
+    size_type bucket_count() const noexcept {
+        return _capacity;
+    }
+
+    float load_factor() const {
+        return static_cast<float>(_size - _has_zero) / _capacity;
+    }
+
+    float max_load_factor() const {
+        return _max_load_factor;
+    }
+
+    /*
+        Sets the maximum ratio of keys to home slots. Values above 0.95 are
+        clamped, since linear probing slows down sharply as the table fills.
+    */
+    void max_load_factor(float ml) {
+        _max_load_factor = ml > _MAX_MAX_LOAD_FACTOR ? _MAX_MAX_LOAD_FACTOR : ml;
+        if (static_cast<float>(_size - _has_zero) > _max_load_factor * _capacity) {
+            _rehash(_grown_capacity(_size - _has_zero));
+        }
+    }
+
+    // Rebuilds the table with at least count home slots, more if the keys would exceed the maximum load factor
+    void rehash(size_type count) {
+        size_type minimum = static_cast<size_type>((_size - _has_zero) / _max_load_factor) + 1;
+        _rehash(count > minimum ? count : minimum);
+    }
+
+    void reserve(size_type count) {
+        rehash(static_cast<size_type>(count / _max_load_factor) + 1);
+    }
+
+    // Bytes of key and value storage per element, overflow area and empty slots included
+    double bytes_per_entry() const {
+        if (_size == 0) {
+            return 0;
+        }
+        return static_cast<double>((_slot_count + _GROUP) * sizeof(Key) + (_slot_count + 1) * sizeof(T)) / _size;
+    }
+
+    iterator begin() {
+        iterator it(this, 0);
+        it._skip_empty();
+        return it;
+    }
+
+    iterator end() {
+        return iterator(this, _slot_count + 1);
+    }
+
+    const_iterator begin() const {
+        return cbegin();
+    }
+
+    const_iterator end() const {
+        return cend();
+    }
+
+    const_iterator cbegin() const {
+        const_iterator it(this, 0);
+        it._skip_empty();
+        return it;
+    }
+
+    const_iterator cend() const {
+        return const_iterator(this, _slot_count + 1);
+    }
+
+    std::pair<iterator, bool> insert(const value_type &value) {
+        auto [index, inserted] = _try_emplace(value.first, value.second);
+        return std::make_pair(iterator(this, index), inserted);
+    }
+
+    std::pair<iterator, bool> insert(value_type &&value) {
+        auto [index, inserted] = _try_emplace(value.first, std::move(value.second));
+        return std::make_pair(iterator(this, index), inserted);
+    }
+
+    // Constructs the value from args only when key is absent
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(Key key, Args &&... args) {
+        auto [index, inserted] = _try_emplace(key, std::forward<Args>(args)...);
+        return std::make_pair(iterator(this, index), inserted);
+    }
+
+    T &operator[](Key key) {
+        // Not _values[_try_emplace(key).first]: _values would be read before a growing insert replaces it
+        size_type index = _try_emplace(key).first;
+        return _values[index].val;
+    }
+
+    T &at(Key key) {
+        size_type index = _find(key);
+        if (index > _slot_count) {
+            throw std::out_of_range("IntegerUnorderedMap::at");
+        }
+        return _values[index].val;
+    }
+
+    const T &at(Key key) const {
+        size_type index = _find(key);
+        if (index > _slot_count) {
+            throw std::out_of_range("IntegerUnorderedMap::at");
+        }
+        return _values[index].val;
+    }
+
+    iterator find(Key key) {
+        return iterator(this, _find(key));
+    }
+
+    const_iterator find(Key key) const {
+        return const_iterator(this, _find(key));
+    }
+
+    bool contains(Key key) const {
+        return _find(key) <= _slot_count;
+    }
+
+    size_type count(Key key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    // Erases the element at pos and returns an iterator to the next one; later elements may have moved
+    iterator erase(const_iterator pos) {
+        size_type index = pos._index;
+        _erase_slot(index);
+        iterator it(this, index);
+        it._skip_empty();
+        return it;
+    }
+
+    iterator erase(iterator pos) {
+        return erase(const_iterator(pos));
+    }
+
+    size_type erase(Key key) {
+        size_type index = _find(key);
+        if (index > _slot_count) {
+            return 0;
+        }
+        _erase_slot(index);
+        return 1;
+    }
+};
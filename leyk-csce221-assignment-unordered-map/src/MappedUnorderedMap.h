@@ -0,0 +1,497 @@
+#pragma once
+
+#include <cstddef>     // size_t
+#include <cstdint>     // uint64_t
+#include <cstdio>      // std::rename, std::remove
+#include <cstring>     // std::memcmp, std::memcpy
+#include <fstream>     // std::ofstream
+#include <iterator>    // std::forward_iterator_tag
+#include <stdexcept>   // std::runtime_error, std::out_of_range
+#include <string>      // std::string
+#include <string_view> // std::string_view
+#include <type_traits> // std::is_trivially_copyable
+#include <utility>     // std::pair, std::exchange, std::swap
+#include <vector>
+
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap, munmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close
+
+#include "hash_functions.h"
+#include "range_hash.h"
+
+/*
+MappedUnorderedMap is a read-only map from strings to T which lives in a
+file. write() lays a map out as an image once; opening the image maps the
+file into memory and finds keys in it directly, so nothing is parsed,
+allocated or rehashed at startup. Pages are read from disk the first time a
+lookup touches them, and processes which open the same image share them
+through the page cache.
+
+The image is a header followed by five arrays, each aligned to 16 bytes:
+
+    bucket_starts  uint64_t[bucket_count + 1]  Entries of bucket b are [bucket_starts[b], bucket_starts[b + 1])
+    codes          uint64_t[size]              Hash code of each entry's key, grouped by bucket
+    key_offsets    uint64_t[size + 1]          Key i is keys[key_offsets[i], key_offsets[i + 1])
+    values         T[size]
+    keys           char[]                      Every key's bytes, back to back
+
+A lookup hashes the key, scans the codes of its bucket, which sit next to
+each other, and compares the key bytes only where a code matches. The
+header records sizeof(T), the byte order and the hash of a fixed string, and
+opening an image written with another T, byte order, Hash or RangeHash
+throws std::runtime_error, as does an image whose header places an array
+outside the file or misaligned. Hash must give the same codes in every
+process: fnv1a_hash or wide_block_hash work, sip_hash with a random key does
+not.
+
+Example usage:
+
+#include "MappedUnorderedMap.h"
+#include "UnorderedMap.h"
+
+int main() {
+    UnorderedMap<std::string, int, fnv1a_hash> map(100);
+    map.insert({"apple", 1});
+    map.insert({"banana", 2});
+
+    MappedUnorderedMap<int>::write("fruit.img", map);   // once, offline
+
+    MappedUnorderedMap<int> image("fruit.img");         // at every startup
+    std::cout << image.find("banana")->second << std::endl;   // 2
+    std::cout << image.contains("cherry") << std::endl;       // 0
+    for (auto const &[key, value]: image) {
+        std::cout << key << ": " << value << std::endl;
+    }
+    return 0;
+}
+
+Differences from UnorderedMap:
+
+- Keys are std::string_views into the mapping, and T must be trivially
+  copyable, since values are stored as their bytes.
+- Nothing can be inserted or erased. To change the map, write a new image
+  and open it.
+- Iterators yield std::pair<std::string_view, const T &> by value, in bucket
+  order.
+- The bucket count is fixed by write(): the smallest RangeHash bucket count
+  that holds one key per bucket.
+
+Big O Notation for operations:
+
+- Write:
+  - Description: Hashes every key, counting-sorts the entries by bucket and writes the image to a
+    temporary file, which is then renamed over path so readers never see a half written image.
+  - Complexity: O(n + bucket_count)
+
+- Open:
+  - Description: Maps the file and checks its header, including that every array lies inside the file.
+    Only the first and last bucket start and key offset are read.
+  - Complexity: O(1)
+
+- Find / Contains / Count / At:
+  - Average case: O(1)
+  - Worst case: O(n) (when all elements hash to the same bucket)
+
+- Size / Bucket count / Begin / End:
+  - Complexity: O(1)
+*/
+
+// A read-only mapping of a whole file, unmapped when it is destroyed
+class mapped_file {
+    const char *_data = nullptr;
+    size_t _size = 0;
+
+public:
+    mapped_file() = default;
+
+    explicit mapped_file(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open " + path);
+        }
+
+        struct stat status{};
+        if (::fstat(fd, &status) != 0 || status.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot read " + path);
+        }
+
+        _size = static_cast<size_t>(status.st_size);
+        void *data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("cannot map " + path);
+        }
+        _data = static_cast<const char *>(data);
+    }
+
+    mapped_file(const mapped_file &) = delete;
+
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    mapped_file(mapped_file &&other) noexcept
+            : _data{std::exchange(other._data, nullptr)}, _size{std::exchange(other._size, 0)} {}
+
+    mapped_file &operator=(mapped_file &&other) noexcept {
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+        return *this;
+    }
+
+    ~mapped_file() {
+        if (_data != nullptr) {
+            ::munmap(const_cast<char *>(_data), _size);
+        }
+    }
+
+    const char *data() const {
+        return _data;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+};
+
+template<typename T, typename Hash = fnv1a_hash, typename RangeHash = prime_range_hash>
+class MappedUnorderedMap {
+public:
+
+    using key_type = std::string_view;
+    using mapped_type = T;
+    using hasher = Hash;
+    using range_hash = RangeHash;
+    using value_type = std::pair<std::string_view, const T &>;
+    using size_type = size_t;
+
+    static_assert(std::is_trivially_copyable<T>::value, "MappedUnorderedMap stores values as their bytes");
+
+private:
+
+    static constexpr char _MAGIC[8] = {'U', 'M', 'A', 'P', 'I', 'M', 'G', '1'};
+    static constexpr uint64_t _BYTE_ORDER = 0x0102030405060708;
+    static constexpr size_t _ALIGNMENT = 16;
+
+    // Hashed at write and open time; differs when the hasher or range hash differ
+    static constexpr std::string_view _PROBE = "MappedUnorderedMap hasher probe";
+
+    struct Header {
+        char magic[8];
+        uint64_t byte_order;
+        uint64_t size;
+        uint64_t bucket_count;
+        uint64_t value_size;
+        uint64_t hash_check;
+        uint64_t bucket_check;
+        uint64_t bucket_starts_offset;
+        uint64_t codes_offset;
+        uint64_t key_offsets_offset;
+        uint64_t values_offset;
+        uint64_t keys_offset;
+        uint64_t file_size;
+    };
+
+    mapped_file _file;
+    size_type _size;
+    size_type _bucket_count;
+    const uint64_t *_bucket_starts;
+    const uint64_t *_codes;
+    const uint64_t *_key_offsets;
+    const T *_values;
+    const char *_keys;
+
+    Hash _hash;
+    RangeHash _range_hash;
+
+    // Buckets of a few probe codes, folded together: the same for the same RangeHash and bucket count
+    static uint64_t _bucket_check(const RangeHash &range, uint64_t code) {
+        uint64_t check = 0;
+        for (uint64_t i = 0; i < 16; i++) {
+            check = check * 1000003 + range(code + i * 0x9E3779B97F4A7C15);
+        }
+        return check;
+    }
+
+    static uint64_t _align(uint64_t offset) {
+        return (offset + _ALIGNMENT - 1) / _ALIGNMENT * _ALIGNMENT;
+    }
+
+    /*
+        Whether an array of count elements of type E at offset is aligned for
+        E and ends inside a file of file_size bytes. Checked by division, so
+        offsets and counts from a damaged header cannot overflow.
+    */
+    template<typename E>
+    static bool _fits(uint64_t offset, uint64_t count, uint64_t file_size) {
+        return offset % alignof(E) == 0 && offset <= file_size && count <= (file_size - offset) / sizeof(E);
+    }
+
+    std::string_view _key(size_type i) const {
+        return std::string_view(_keys + _key_offsets[i], _key_offsets[i + 1] - _key_offsets[i]);
+    }
+
+    // Index of the entry holding key, or _size if there is none
+    size_type _find(std::string_view key) const {
+        uint64_t code = _hash(key);
+        size_type bucket = _range_hash(code);
+        for (size_type i = _bucket_starts[bucket]; i < _bucket_starts[bucket + 1]; i++) {
+            if (_codes[i] == code && _key(i) == key) {
+                return i;
+            }
+        }
+        return _size;
+    }
+
+    void _check(bool ok, const std::string &path, const char *what) {
+        if (!ok) {
+            throw std::runtime_error(path + ": " + what);
+        }
+    }
+
+public:
+
+    class const_iterator {
+        friend class MappedUnorderedMap;
+
+        const MappedUnorderedMap *_map = nullptr;
+        size_type _index = 0;
+
+        const_iterator(const MappedUnorderedMap *map, size_type index) : _map{map}, _index{index} {}
+
+        // operator-> has to return something with an operator-> of its own, so it wraps the pair
+        struct arrow {
+            value_type pair;
+
+            const value_type *operator->() const {
+                return &pair;
+            }
+        };
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = MappedUnorderedMap::value_type;
+        using difference_type = ptrdiff_t;
+        using reference = value_type;
+        using pointer = arrow;
+
+        const_iterator() = default;
+
+        value_type operator*() const {
+            return value_type(_map->_key(_index), _map->_values[_index]);
+        }
+
+        arrow operator->() const {
+            return arrow{**this};
+        }
+
+        const_iterator &operator++() {
+            _index++;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            _index++;
+            return old;
+        }
+
+        friend bool operator==(const const_iterator &a, const const_iterator &b) {
+            return a._index == b._index;
+        }
+
+        friend bool operator!=(const const_iterator &a, const const_iterator &b) {
+            return a._index != b._index;
+        }
+    };
+
+    using iterator = const_iterator;
+
+    /*
+        Writes the elements of map, any container with cbegin() and cend()
+        over pairs whose first converts to std::string_view and whose second
+        is a T, as an image at path.
+        Keys must be distinct, as they are in a map.
+    */
+    template<typename Map>
+    static void write(const std::string &path, const Map &map, const Hash &hash = Hash{}) {
+        std::vector<std::string_view> keys;
+        std::vector<T> values;
+        for (auto it = map.cbegin(); it != map.cend(); it++) {
+            keys.emplace_back((*it).first);
+            values.push_back((*it).second);
+        }
+
+        size_type size = keys.size();
+        size_type bucket_count = RangeHash::bucket_count(size);
+        RangeHash range(bucket_count);
+
+        // Counting sort by bucket
+        std::vector<uint64_t> codes(size);
+        std::vector<uint64_t> bucket_starts(bucket_count + 1, 0);
+        for (size_type i = 0; i < size; i++) {
+            codes[i] = hash(keys[i]);
+            bucket_starts[range(codes[i]) + 1]++;
+        }
+        for (size_type bucket = 0; bucket < bucket_count; bucket++) {
+            bucket_starts[bucket + 1] += bucket_starts[bucket];
+        }
+        std::vector<size_type> order(size);
+        std::vector<uint64_t> next(bucket_starts.begin(), bucket_starts.end() - 1);
+        for (size_type i = 0; i < size; i++) {
+            order[next[range(codes[i])]++] = i;
+        }
+
+        std::vector<uint64_t> sorted_codes(size);
+        std::vector<uint64_t> key_offsets(size + 1, 0);
+        std::vector<T> sorted_values;
+        std::string key_bytes;
+        sorted_values.reserve(size);
+        for (size_type i = 0; i < size; i++) {
+            sorted_codes[i] = codes[order[i]];
+            key_offsets[i + 1] = key_offsets[i] + keys[order[i]].size();
+            sorted_values.push_back(values[order[i]]);
+            key_bytes += keys[order[i]];
+        }
+
+        Header header{};
+        std::memcpy(header.magic, _MAGIC, sizeof(_MAGIC));
+        header.byte_order = _BYTE_ORDER;
+        header.size = size;
+        header.bucket_count = bucket_count;
+        header.value_size = sizeof(T);
+        header.hash_check = hash(_PROBE);
+        header.bucket_check = _bucket_check(range, header.hash_check);
+        header.bucket_starts_offset = _align(sizeof(Header));
+        header.codes_offset = _align(header.bucket_starts_offset + sizeof(uint64_t) * (bucket_count + 1));
+        header.key_offsets_offset = _align(header.codes_offset + sizeof(uint64_t) * size);
+        header.values_offset = _align(header.key_offsets_offset + sizeof(uint64_t) * (size + 1));
+        header.keys_offset = _align(header.values_offset + sizeof(T) * size);
+        header.file_size = header.keys_offset + key_offsets[size];
+
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            auto section = [&out](uint64_t offset, const void *data, size_t bytes) {
+                while (static_cast<uint64_t>(out.tellp()) < offset) {
+                    out.put('\0');
+                }
+                out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+            };
+            section(0, &header, sizeof(header));
+            section(header.bucket_starts_offset, bucket_starts.data(), sizeof(uint64_t) * bucket_starts.size());
+            section(header.codes_offset, sorted_codes.data(), sizeof(uint64_t) * size);
+            section(header.key_offsets_offset, key_offsets.data(), sizeof(uint64_t) * key_offsets.size());
+            section(header.values_offset, sorted_values.data(), sizeof(T) * size);
+            section(header.keys_offset, key_bytes.data(), key_bytes.size());
+            if (!out.flush()) {
+                std::remove(temporary.c_str());
+                throw std::runtime_error("cannot write " + temporary);
+            }
+        }
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("cannot rename " + temporary + " to " + path);
+        }
+    }
+
+    // Maps the image at path. Throws std::runtime_error if it cannot be read or was written differently.
+    explicit MappedUnorderedMap(const std::string &path, const Hash &hash = Hash{})
+            : _file{path}, _hash{hash} {
+        const char *data = _file.data();
+        _check(_file.size() >= sizeof(Header), path, "too short for a header");
+
+        Header header;
+        std::memcpy(&header, data, sizeof(header));
+        _check(std::memcmp(header.magic, _MAGIC, sizeof(_MAGIC)) == 0, path, "not an UnorderedMap image");
+        _check(header.byte_order == _BYTE_ORDER, path, "written with another byte order");
+        _check(header.value_size == sizeof(T), path, "written with another value type");
+        _check(header.file_size == _file.size(), path, "truncated or padded");
+        // Every entry takes 8 bytes or more, so neither count can exceed the file size, and count + 1 cannot overflow
+        _check(header.bucket_count > 0 && header.bucket_count < header.file_size && header.size < header.file_size &&
+               _fits<uint64_t>(header.bucket_starts_offset, header.bucket_count + 1, header.file_size) &&
+               _fits<uint64_t>(header.codes_offset, header.size, header.file_size) &&
+               _fits<uint64_t>(header.key_offsets_offset, header.size + 1, header.file_size) &&
+               _fits<T>(header.values_offset, header.size, header.file_size) &&
+               _fits<char>(header.keys_offset, 0, header.file_size), path, "corrupt header");
+        _check(header.hash_check == _hash(_PROBE), path, "written with another hasher");
+
+        _size = header.size;
+        _bucket_count = header.bucket_count;
+        _range_hash = RangeHash(_bucket_count);
+        _check(RangeHash::bucket_count(_bucket_count) == _bucket_count &&
+               header.bucket_check == _bucket_check(_range_hash, header.hash_check), path,
+               "written with another range hash");
+
+        _bucket_starts = reinterpret_cast<const uint64_t *>(data + header.bucket_starts_offset);
+        _codes = reinterpret_cast<const uint64_t *>(data + header.codes_offset);
+        _key_offsets = reinterpret_cast<const uint64_t *>(data + header.key_offsets_offset);
+        _values = reinterpret_cast<const T *>(data + header.values_offset);
+        _keys = data + header.keys_offset;
+
+        // The last entries bound every bucket and key; checking them is O(1), unlike checking each entry
+        _check(_bucket_starts[0] == 0 && _bucket_starts[_bucket_count] == _size && _key_offsets[0] == 0 &&
+               _key_offsets[_size] == header.file_size - header.keys_offset, path, "corrupt arrays");
+    }
+
+    size_type size() const noexcept {
+        return _size;
+    }
+
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+
+    size_type bucket_count() const noexcept {
+        return _bucket_count;
+    }
+
+    float load_factor() const {
+        return static_cast<float>(_size) / _bucket_count;
+    }
+
+    size_type bucket(std::string_view key) const {
+        return _range_hash(_hash(key));
+    }
+
+    size_type bucket_size(size_type n) const {
+        return _bucket_starts[n + 1] - _bucket_starts[n];
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, _size);
+    }
+
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    const_iterator cend() const {
+        return end();
+    }
+
+    const_iterator find(std::string_view key) const {
+        return const_iterator(this, _find(key));
+    }
+
+    bool contains(std::string_view key) const {
+        return _find(key) != _size;
+    }
+
+    size_type count(std::string_view key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    const T &at(std::string_view key) const {
+        size_type i = _find(key);
+        if (i == _size) {
+            throw std::out_of_range("MappedUnorderedMap::at");
+        }
+        return _values[i];
+    }
+};
@@ -0,0 +1,461 @@
+#pragma once
+
+#include <atomic>     // std::atomic, std::atomic_thread_fence
+#include <cstddef>    // size_t
+#include <cstdint>    // uint64_t
+#include <functional> // std::hash
+#include <memory>     // std::unique_ptr
+#include <mutex>      // std::mutex, std::lock_guard
+#include <optional>   // std::optional
+#include <stdexcept>  // std::invalid_argument
+#include <thread>     // std::this_thread::yield
+#include <utility>    // std::pair
+#include <vector>
+
+#include "range_hash.h"
+
+/*
+RcuUnorderedMap is a chained hash map for tables which are read far more
+often than they are written. Readers never lock: they announce themselves in
+an epoch, walk the buckets with acquire loads and leave. Writers take one
+mutex among themselves and publish every change with a single release store,
+so a reader sees each bucket either before or after a change, never halfway.
+
+- Insert links a fully built node at the front of its bucket.
+- Erase unlinks a node, and insert_or_assign on an existing key replaces the
+  node with a new one, so a value is never written while a reader may see it.
+- Growing builds a new bucket array with copies of every node and publishes
+  it in one store. Readers still walking the old array keep seeing a
+  complete, unchanging table.
+
+Unlinked nodes and old tables are "retired" instead of freed, because a
+reader may still be looking at them. Readers count themselves in one of two
+epoch counters (striped over cache lines so readers on different cores do not
+share one). Once enough has been retired, a writer moves to the next epoch,
+waits for the readers of the previous one to leave, and frees everything
+retired before the switch; readers which start after the switch can no longer
+reach it.
+
+Example usage:
+
+#include "RcuUnorderedMap.h"
+#include <thread>
+
+int main() {
+    RcuUnorderedMap<std::string, std::string> routes;
+    routes.insert({"/", "index"});
+
+    std::thread reader([&routes] {
+        for (int i = 0; i < 1000; i++) {
+            std::optional<std::string> route = routes.find("/");   // never blocks
+        }
+    });
+    routes.insert_or_assign("/", "home");
+    reader.join();
+
+    std::cout << *routes.find("/") << std::endl;   // home
+    return 0;
+}
+
+Differences from UnorderedMap:
+
+- There are no iterators; find returns a copy of the value, and visit and
+  for_each run a function under the read side instead.
+- The map grows once size() exceeds max_load_factor() * bucket_count()
+  (1.0 by default), by copying every element. T must be copy constructible.
+- A write holds the writers' mutex, and now and then also waits for the
+  readers of the previous epoch to finish.
+
+Big O Notation for operations:
+
+- Find / Contains / Visit:
+  - Description: Lock free. Two atomic increments of the reader's own counter stripe plus the lookup.
+  - Average case: O(1)
+  - Worst case: O(n) (when all elements hash to the same bucket)
+
+- Insert / Insert or assign / Erase:
+  - Description: Takes the writers' mutex. Retiring amortizes to O(1) per change, plus the time the
+    previous epoch's readers take to finish.
+  - Average case: O(1) amortized, O(n) when the map grows
+  - Worst case: O(n) (when all elements hash to the same bucket)
+
+- Synchronize:
+  - Description: Frees everything retired so far, waiting for readers which may still see it.
+  - Complexity: O(retired)
+*/
+
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename Pred = std::equal_to<Key>,
+        typename RangeHash = prime_range_hash>
+class RcuUnorderedMap {
+public:
+
+    using key_type = Key;
+    using mapped_type = T;
+    using hasher = Hash;
+    using key_equal = Pred;
+    using value_type = std::pair<const key_type, mapped_type>;
+    using size_type = size_t;
+
+private:
+
+    struct Node {
+        std::atomic<Node *> next;
+        size_type code;
+        value_type val;
+
+        template<typename... Args>
+        explicit Node(size_type code, Args &&... args) : next{nullptr}, code{code}, val(std::forward<Args>(args)...) {}
+    };
+
+    struct Table {
+        size_type bucket_count;
+        RangeHash range_hash;
+        std::unique_ptr<std::atomic<Node *>[]> buckets;
+
+        explicit Table(size_type bucket_count)
+                : bucket_count{bucket_count}, range_hash(bucket_count),
+                  buckets{new std::atomic<Node *>[bucket_count]} {
+            for (size_type i = 0; i < bucket_count; i++) {
+                buckets[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        // Frees the nodes still linked in the table. Only called once no reader can reach it.
+        void destroy_nodes() {
+            for (size_type i = 0; i < bucket_count; i++) {
+                Node *node = buckets[i].load(std::memory_order_relaxed);
+                while (node != nullptr) {
+                    Node *next = node->next.load(std::memory_order_relaxed);
+                    delete node;
+                    node = next;
+                }
+            }
+        }
+    };
+
+    // Either a node or a whole table which no longer belongs to the map
+    struct Retired {
+        Node *node;
+        Table *table;
+    };
+
+    static constexpr size_type _N_STRIPES = 64;
+    static constexpr size_type _RETIRE_BATCH = 64;
+
+    // Readers of each epoch parity, one counter per cache line
+    struct alignas(64) ReaderStripe {
+        std::atomic<size_type> readers[2];
+    };
+
+    std::atomic<Table *> _table;
+    std::atomic<size_type> _size;
+    // Atomic so max_load_factor() can read it without the writer lock while a writer sets it
+    std::atomic<float> _max_load_factor;
+
+    std::atomic<uint64_t> _epoch;
+    std::unique_ptr<ReaderStripe[]> _stripes;
+
+    std::mutex _write_mutex;
+    std::vector<Retired> _retired;
+
+    Hash _hash;
+    key_equal _equal;
+
+    static size_type _stripe() {
+        static std::atomic<size_type> nextStripe{0};
+        thread_local size_type stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % _N_STRIPES;
+        return stripe;
+    }
+
+    /*
+        Marks the calling thread as a reader for its lifetime. After
+        counting itself in the current epoch the reader checks the epoch is
+        still current; if a writer switched in between, it may already have
+        stopped waiting for that epoch, so the reader counts itself again in
+        the new one. The check is an acquire load, so a reader which sees
+        the new epoch also sees every unlink made before the switch.
+    */
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const RcuUnorderedMap &map) : _counter{nullptr} {
+            ReaderStripe &stripe = map._stripes[_stripe()];
+            while (true) {
+                uint64_t epoch = map._epoch.load(std::memory_order_relaxed);
+                _counter = &stripe.readers[epoch & 1];
+                _counter->fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (map._epoch.load(std::memory_order_acquire) == epoch) {
+                    return;
+                }
+                _counter->fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        ReadGuard(const ReadGuard &) = delete;
+
+        ReadGuard &operator=(const ReadGuard &) = delete;
+
+        ~ReadGuard() {
+            _counter->fetch_sub(1, std::memory_order_release);
+        }
+
+    private:
+        std::atomic<size_type> *_counter;
+    };
+
+    template<typename K>
+    const Node *_find(const Table *table, size_type code, const K &key) const {
+        const Node *node = table->buckets[table->range_hash(code)].load(std::memory_order_acquire);
+        for (; node != nullptr; node = node->next.load(std::memory_order_acquire)) {
+            if (node->code == code && _equal(node->val.first, key)) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    // Writer side: the atomic holding the pointer to key's node, or the bucket's null end if key is missing
+    std::atomic<Node *> *_find_link(Table *table, size_type code, const Key &key) {
+        std::atomic<Node *> *link = &table->buckets[table->range_hash(code)];
+        for (Node *node = link->load(std::memory_order_relaxed); node != nullptr;
+             node = link->load(std::memory_order_relaxed)) {
+            if (node->code == code && _equal(node->val.first, key)) {
+                return link;
+            }
+            link = &node->next;
+        }
+        return link;
+    }
+
+    /*
+        Moves to the next epoch and waits until no reader is left in the one
+        before, then frees everything which was retired before the switch.
+        Called with the writers' mutex held.
+    */
+    void _reclaim() {
+        if (_retired.empty()) {
+            return;
+        }
+
+        uint64_t oldEpoch = _epoch.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (size_type i = 0; i < _N_STRIPES; i++) {
+            while (_stripes[i].readers[oldEpoch & 1].load(std::memory_order_acquire) != 0) {
+                std::this_thread::yield();
+            }
+        }
+
+        for (Retired &retired: _retired) {
+            if (retired.table != nullptr) {
+                retired.table->destroy_nodes();
+                delete retired.table;
+            } else {
+                delete retired.node;
+            }
+        }
+        _retired.clear();
+    }
+
+    void _retire(Node *node, Table *table) {
+        _retired.push_back(Retired{node, table});
+        if (_retired.size() >= _RETIRE_BATCH) {
+            _reclaim();
+        }
+    }
+
+    /*
+        Builds a table with bucket_count buckets holding copies of every node
+        and publishes it; the old table and its nodes are retired together.
+    */
+    void _grow(Table *table, size_type bucket_count) {
+        Table *newTable = new Table(RangeHash::bucket_count(bucket_count));
+        for (size_type i = 0; i < table->bucket_count; i++) {
+            for (Node *node = table->buckets[i].load(std::memory_order_relaxed); node != nullptr;
+                 node = node->next.load(std::memory_order_relaxed)) {
+                Node *copy = new Node(node->code, node->val);
+                std::atomic<Node *> &bucket = newTable->buckets[newTable->range_hash(node->code)];
+                copy->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                bucket.store(copy, std::memory_order_relaxed);
+            }
+        }
+        _table.store(newTable, std::memory_order_release);
+        _retire(nullptr, table);
+    }
+
+    // Links a new node for key unless key is present. Called with the writers' mutex held.
+    template<typename... Args>
+    bool _insert(const Key &key, Args &&... args) {
+        Table *table = _table.load(std::memory_order_relaxed);
+        size_type code = _hash(key);
+        std::atomic<Node *> *link = _find_link(table, code, key);
+        if (link->load(std::memory_order_relaxed) != nullptr) {
+            return false;
+        }
+
+        if (_size.load(std::memory_order_relaxed) + 1 >
+            _max_load_factor.load(std::memory_order_relaxed) * table->bucket_count) {
+            _grow(table, 2 * table->bucket_count);
+            table = _table.load(std::memory_order_relaxed);
+        }
+
+        Node *node = new Node(code, std::forward<Args>(args)...);
+        std::atomic<Node *> &bucket = table->buckets[table->range_hash(code)];
+        node->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        bucket.store(node, std::memory_order_release);
+        _size.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+public:
+
+    explicit RcuUnorderedMap(size_type bucket_count = 0, const Hash &hash = Hash{}, const key_equal &equal = key_equal{})
+            : _table{new Table(RangeHash::bucket_count(bucket_count))}, _size{0}, _max_load_factor{1.0f},
+              _epoch{0}, _stripes{new ReaderStripe[_N_STRIPES]}, _hash{hash}, _equal{equal} {
+        for (size_type i = 0; i < _N_STRIPES; i++) {
+            _stripes[i].readers[0].store(0, std::memory_order_relaxed);
+            _stripes[i].readers[1].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    RcuUnorderedMap(const RcuUnorderedMap &) = delete;
+
+    RcuUnorderedMap &operator=(const RcuUnorderedMap &) = delete;
+
+    // No reader may still be running
+    ~RcuUnorderedMap() {
+        synchronize();
+        Table *table = _table.load(std::memory_order_relaxed);
+        table->destroy_nodes();
+        delete table;
+    }
+
+    size_type size() const {
+        return _size.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_type bucket_count() const {
+        ReadGuard guard(*this);
+        return _table.load(std::memory_order_acquire)->bucket_count;
+    }
+
+    float max_load_factor() const {
+        return _max_load_factor.load(std::memory_order_relaxed);
+    }
+
+    // Sets the load factor above which the map grows. Takes effect with the next insert.
+    // Zero, negative values and NaN throw std::invalid_argument.
+    void max_load_factor(float ml) {
+        if (!(ml > 0.0f)) {
+            throw std::invalid_argument("max_load_factor must be positive");
+        }
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        _max_load_factor.store(ml, std::memory_order_relaxed);
+    }
+
+    // A copy of key's value, or nothing if key is missing. Never blocks.
+    std::optional<T> find(const Key &key) const {
+        size_type code = _hash(key);
+        ReadGuard guard(*this);
+        const Node *node = _find(_table.load(std::memory_order_acquire), code, key);
+        if (node == nullptr) {
+            return std::nullopt;
+        }
+        return node->val.second;
+    }
+
+    bool contains(const Key &key) const {
+        size_type code = _hash(key);
+        ReadGuard guard(*this);
+        return _find(_table.load(std::memory_order_acquire), code, key) != nullptr;
+    }
+
+    // Calls fn(value) on key's value while it is protected from reclamation. Returns whether key was found.
+    template<typename F>
+    bool visit(const Key &key, F fn) const {
+        size_type code = _hash(key);
+        ReadGuard guard(*this);
+        const Node *node = _find(_table.load(std::memory_order_acquire), code, key);
+        if (node == nullptr) {
+            return false;
+        }
+        fn(node->val.second);
+        return true;
+    }
+
+    // Calls fn(key, value) for every element of one snapshot of the buckets
+    template<typename F>
+    void for_each(F fn) const {
+        ReadGuard guard(*this);
+        const Table *table = _table.load(std::memory_order_acquire);
+        for (size_type i = 0; i < table->bucket_count; i++) {
+            for (const Node *node = table->buckets[i].load(std::memory_order_acquire); node != nullptr;
+                 node = node->next.load(std::memory_order_acquire)) {
+                fn(node->val.first, node->val.second);
+            }
+        }
+    }
+
+    bool insert(const value_type &value) {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        return _insert(value.first, value);
+    }
+
+    // Inserts (key, obj) or replaces key's node with one holding obj. Returns whether key was inserted.
+    template<typename M>
+    bool insert_or_assign(const Key &key, M &&obj) {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        Table *table = _table.load(std::memory_order_relaxed);
+        size_type code = _hash(key);
+        std::atomic<Node *> *link = _find_link(table, code, key);
+        Node *oldNode = link->load(std::memory_order_relaxed);
+        if (oldNode == nullptr) {
+            return _insert(key, key, std::forward<M>(obj));
+        }
+
+        Node *node = new Node(code, key, std::forward<M>(obj));
+        node->next.store(oldNode->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        link->store(node, std::memory_order_release);
+        _retire(oldNode, nullptr);
+        return false;
+    }
+
+    size_type erase(const Key &key) {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        Table *table = _table.load(std::memory_order_relaxed);
+        std::atomic<Node *> *link = _find_link(table, _hash(key), key);
+        Node *node = link->load(std::memory_order_relaxed);
+        if (node == nullptr) {
+            return 0;
+        }
+
+        link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+        _size.fetch_sub(1, std::memory_order_relaxed);
+        _retire(node, nullptr);
+        return 1;
+    }
+
+    // Replaces the buckets with empty ones; the old table and its nodes are retired
+    void clear() {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        Table *table = _table.load(std::memory_order_relaxed);
+        _table.store(new Table(table->bucket_count), std::memory_order_release);
+        _size.store(0, std::memory_order_relaxed);
+        _retire(nullptr, table);
+    }
+
+    // Frees everything retired so far. Waits for readers which started before the call.
+    void synchronize() {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        _reclaim();
+    }
+
+    // Number of nodes and tables waiting to be freed
+    size_type retired() {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        return _retired.size();
+    }
+};
@@ -0,0 +1,498 @@
+#pragma once
+
+#include <array>            // std::array
+#include <cstddef>          // size_t
+#include <cstdint>          // uint16_t, uint32_t, uint64_t
+#include <functional>       // std::hash, std::equal_to
+#include <initializer_list>
+#include <iterator>         // std::iterator_traits
+#include <stdexcept>        // std::invalid_argument, std::out_of_range
+#include <string_view>      // std::string_view
+#include <utility>          // std::pair
+#include <vector>
+
+#include "range_hash.h"
+
+/*
+StaticUnorderedMap is a map built once from a fixed set of keys and never
+changed afterwards, such as the word lists in data_files. Its keys are laid
+out by a minimal perfect hash: every key has a slot of its own among
+exactly size() slots, so a lookup computes the slot and compares one key,
+hit or miss. There are no chains and no empty slots.
+
+The perfect hash is a hash-and-displace scheme in the style of PTHash.
+Keys are split into buckets of about _PERFECT_HASH_KEYS_PER_BUCKET keys,
+and each bucket is given a 16-bit pilot such that
+
+    slot(key) = (code(key) ^ mix(pilot of key's bucket)) % slot_count
+
+puts its keys in slots no other key holds. As in PTHash, 60% of the keys
+go to the first 30% of the buckets, and buckets are placed largest first,
+so the big ones land while the table is still empty and only small ones
+are left for the crowded end. slot_count is n + n / 64 + 1, a little over
+n, so the last buckets still find room. The few slots at or past n are
+then remapped to the free slots below n through a small table.
+
+The index takes 16 bits per bucket plus 32 bits per remapped slot, about
+3.2 bits per key in all; bits_per_key() reports it. The keys and values
+themselves are stored once, in slot order.
+
+If no pilot places some bucket, for instance because two keys are equal,
+the build retries with a new seed. It throws std::invalid_argument after
+_PERFECT_HASH_MAX_SEEDS attempts; with distinct keys that does not happen.
+
+make_static_string_map builds the same structure for string_view keys at
+compile time, as a constexpr StaticStringMap of fixed size.
+
+Example usage:
+
+#include "StaticUnorderedMap.h"
+#include <iostream>
+
+constexpr auto COLORS = make_static_string_map<int>({
+    {"red", 0xFF0000}, {"green", 0x00FF00}, {"blue", 0x0000FF}
+});
+static_assert(*COLORS.find("green") == 0x00FF00);
+
+int main() {
+    StaticUnorderedMap<std::string, int> map({{"apple", 1}, {"banana", 2}, {"cherry", 3}});
+    std::cout << map.find("banana")->second << std::endl;   // 2
+    std::cout << map.contains("durian") << std::endl;       // 0
+    std::cout << COLORS.contains("blue") << std::endl;      // 1
+    return 0;
+}
+
+Big O Notation for operations:
+
+- Build:
+  - Description: Hashes every key once per seed tried, sorts the buckets by size and searches a pilot for
+    each. Almost always succeeds with the first seed.
+  - Expected case: O(n)
+
+- Find / Contains / Count / At:
+  - Description: One hash, one pilot, one slot, one key comparison.
+  - Worst case: O(1)
+
+- Size / Begin / End:
+  - Complexity: O(1)
+*/
+
+constexpr size_t _PERFECT_HASH_KEYS_PER_BUCKET = 6;
+constexpr uint32_t _PERFECT_HASH_MAX_PILOT = 65535;
+constexpr uint64_t _PERFECT_HASH_MAX_SEEDS = 64;
+
+// The code of a key is its hash mixed with the seed, so each seed gives the build other codes
+constexpr uint64_t _perfect_hash_code(uint64_t hash, uint64_t seed) {
+    return _mix_hash_code(hash ^ _mix_hash_code(seed + 0x9E3779B97F4A7C15ull));
+}
+
+constexpr size_t _perfect_hash_bucket_count(size_t n) {
+    return n == 0 ? 1 : (n + _PERFECT_HASH_KEYS_PER_BUCKET - 1) / _PERFECT_HASH_KEYS_PER_BUCKET;
+}
+
+constexpr size_t _perfect_hash_slot_count(size_t n) {
+    return n + n / 64 + 1;
+}
+
+// 60% of the codes (those whose high half is below 0.6 * 2^32) go to the first 30% of the buckets
+constexpr size_t _perfect_hash_bucket(uint64_t code, size_t bucket_count) {
+    size_t dense = (3 * bucket_count + 9) / 10;
+    uint64_t high = code >> 32;
+    if (high < 0x99999999ull || dense == bucket_count) {
+        return static_cast<size_t>(high % dense);
+    }
+    return dense + static_cast<size_t>(high % (bucket_count - dense));
+}
+
+constexpr size_t _perfect_hash_slot(uint64_t code, uint64_t pilot, size_t slot_count) {
+    return static_cast<size_t>((code ^ _mix_hash_code(pilot + 1)) % slot_count);
+}
+
+/*
+    Finds a pilot for every bucket of the n codes, then remaps the slots at
+    or past n onto the free ones below it. On success slot_of[i] is the slot
+    of code i, in [0, n). Returns false if some bucket has no pilot.
+
+    Every container is indexed with [] and has room for what it holds:
+    pilots and bucket_order the bucket count, bucket_start one more, members
+    and slot_of n, remap slot_count - n, taken slot_count. Written against
+    that interface alone so std::vector serves the runtime build and
+    std::array the constexpr one.
+*/
+template<typename Codes, typename Pilots, typename Remap, typename SlotOf, typename Starts, typename Members,
+        typename Order, typename Flags>
+constexpr bool _perfect_hash_build(const Codes &codes, size_t n, Pilots &pilots, Remap &remap, SlotOf &slot_of,
+                                   Starts &bucket_start, Members &members, Order &bucket_order, Flags &taken) {
+    size_t bucket_count = _perfect_hash_bucket_count(n);
+    size_t slot_count = _perfect_hash_slot_count(n);
+
+    // Counting sort of the keys by bucket
+    for (size_t b = 0; b <= bucket_count; b++) {
+        bucket_start[b] = 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        bucket_start[_perfect_hash_bucket(codes[i], bucket_count) + 1]++;
+    }
+    for (size_t b = 0; b < bucket_count; b++) {
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    for (size_t i = 0; i < n; i++) {
+        size_t b = _perfect_hash_bucket(codes[i], bucket_count);
+        members[bucket_start[b]++] = i;
+    }
+    for (size_t b = bucket_count; b > 0; b--) {
+        bucket_start[b] = bucket_start[b - 1];
+    }
+    bucket_start[0] = 0;
+
+    // Largest buckets first: a selection by size, one pass per size, fine since sizes are small
+    size_t placed = 0;
+    size_t largest = 0;
+    for (size_t b = 0; b < bucket_count; b++) {
+        size_t size = bucket_start[b + 1] - bucket_start[b];
+        largest = size > largest ? size : largest;
+    }
+    for (size_t size = largest + 1; size-- > 0;) {
+        for (size_t b = 0; b < bucket_count; b++) {
+            if (bucket_start[b + 1] - bucket_start[b] == size) {
+                bucket_order[placed++] = b;
+            }
+        }
+    }
+
+    for (size_t s = 0; s < slot_count; s++) {
+        taken[s] = false;
+    }
+    for (size_t o = 0; o < bucket_count; o++) {
+        size_t b = bucket_order[o];
+        pilots[b] = 0;
+        if (bucket_start[b] == bucket_start[b + 1]) {
+            continue;
+        }
+
+        bool found = false;
+        for (uint64_t pilot = 0; pilot <= _PERFECT_HASH_MAX_PILOT && !found; pilot++) {
+            size_t j = bucket_start[b];
+            for (; j < bucket_start[b + 1]; j++) {
+                size_t slot = _perfect_hash_slot(codes[members[j]], pilot, slot_count);
+                if (taken[slot]) {
+                    break;
+                }
+                taken[slot] = true;
+                slot_of[members[j]] = slot;
+            }
+            if (j == bucket_start[b + 1]) {
+                pilots[b] = static_cast<uint16_t>(pilot);
+                found = true;
+            } else {
+                // Undo the keys of this bucket placed before the clash
+                for (size_t k = bucket_start[b]; k < j; k++) {
+                    taken[slot_of[members[k]]] = false;
+                }
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+
+    // n keys sit in slot_count slots, so the slots taken past n match the free ones below it
+    size_t free_slot = 0;
+    for (size_t s = n; s < slot_count; s++) {
+        remap[s - n] = 0;
+        if (taken[s]) {
+            while (taken[free_slot]) {
+                free_slot++;
+            }
+            taken[free_slot] = true;
+            remap[s - n] = static_cast<uint32_t>(free_slot);
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (slot_of[i] >= n) {
+            slot_of[i] = remap[slot_of[i] - n];
+        }
+    }
+    return true;
+}
+
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename Pred = std::equal_to<Key>>
+class StaticUnorderedMap {
+public:
+
+    using key_type = Key;
+    using mapped_type = T;
+    using hasher = Hash;
+    using key_equal = Pred;
+    using value_type = std::pair<const key_type, mapped_type>;
+    using size_type = size_t;
+    using iterator = value_type *;
+    using const_iterator = const value_type *;
+
+private:
+
+    std::vector<uint16_t> _pilots;
+    std::vector<uint32_t> _remap;
+    std::vector<value_type> _slots;
+    uint64_t _seed;
+
+    Hash _hash;
+    key_equal _equal;
+
+    size_type _slot(const Key &key) const {
+        uint64_t code = _perfect_hash_code(_hash(key), _seed);
+        size_type slot = _perfect_hash_slot(code, _pilots[_perfect_hash_bucket(code, _pilots.size())],
+                                            _perfect_hash_slot_count(_slots.size()));
+        return slot < _slots.size() ? slot : _remap[slot - _slots.size()];
+    }
+
+    // The element key would be in, if it is in the map at all
+    const value_type *_find(const Key &key) const {
+        if (_slots.empty()) {
+            return nullptr;
+        }
+        const value_type *candidate = &_slots[_slot(key)];
+        return _equal(candidate->first, key) ? candidate : nullptr;
+    }
+
+    void _build(std::vector<std::pair<Key, T>> &&pairs) {
+        size_type n = pairs.size();
+        size_type bucket_count = _perfect_hash_bucket_count(n);
+        size_type slot_count = _perfect_hash_slot_count(n);
+
+        std::vector<uint64_t> hashes(n);
+        for (size_type i = 0; i < n; i++) {
+            hashes[i] = _hash(pairs[i].first);
+        }
+
+        std::vector<uint64_t> codes(n);
+        std::vector<size_type> slot_of(n);
+        std::vector<size_type> bucket_start(bucket_count + 1);
+        std::vector<size_type> members(n);
+        std::vector<size_type> bucket_order(bucket_count);
+        std::vector<bool> taken(slot_count);
+        _pilots.assign(bucket_count, 0);
+        _remap.assign(slot_count - n, 0);
+
+        for (_seed = 0; _seed < _PERFECT_HASH_MAX_SEEDS; _seed++) {
+            for (size_type i = 0; i < n; i++) {
+                codes[i] = _perfect_hash_code(hashes[i], _seed);
+            }
+            if (_perfect_hash_build(codes, n, _pilots, _remap, slot_of, bucket_start, members, bucket_order,
+                                    taken)) {
+                break;
+            }
+        }
+        if (_seed == _PERFECT_HASH_MAX_SEEDS) {
+            throw std::invalid_argument("StaticUnorderedMap: no perfect hash found; are the keys distinct?");
+        }
+
+        // Lay the elements out in slot order
+        std::vector<size_type> at_slot(n);
+        for (size_type i = 0; i < n; i++) {
+            at_slot[slot_of[i]] = i;
+        }
+        _slots.reserve(n);
+        for (size_type slot = 0; slot < n; slot++) {
+            _slots.emplace_back(std::move(pairs[at_slot[slot]].first), std::move(pairs[at_slot[slot]].second));
+        }
+    }
+
+public:
+
+    // Builds the map from the pairs of [first, last). Keys must be distinct.
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    StaticUnorderedMap(InputIt first, InputIt last, const Hash &hash = Hash{}, const key_equal &equal = key_equal{})
+            : _seed{0}, _hash{hash}, _equal{equal} {
+        std::vector<std::pair<Key, T>> pairs;
+        for (; first != last; first++) {
+            pairs.emplace_back((*first).first, (*first).second);
+        }
+        _build(std::move(pairs));
+    }
+
+    StaticUnorderedMap(std::initializer_list<std::pair<Key, T>> init, const Hash &hash = Hash{},
+                       const key_equal &equal = key_equal{})
+            : StaticUnorderedMap(init.begin(), init.end(), hash, equal) {}
+
+    size_type size() const noexcept {
+        return _slots.size();
+    }
+
+    bool empty() const noexcept {
+        return _slots.empty();
+    }
+
+    // Size of the perfect hash index (pilots and remap table) in bits per key
+    double bits_per_key() const {
+        if (_slots.empty()) {
+            return 0;
+        }
+        return (16.0 * _pilots.size() + 32.0 * _remap.size()) / _slots.size();
+    }
+
+    iterator begin() {
+        return _slots.data();
+    }
+
+    iterator end() {
+        return _slots.data() + _slots.size();
+    }
+
+    const_iterator begin() const {
+        return _slots.data();
+    }
+
+    const_iterator end() const {
+        return _slots.data() + _slots.size();
+    }
+
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    const_iterator cend() const {
+        return end();
+    }
+
+    // Keys are fixed, but values can be changed through the iterator
+    iterator find(const Key &key) {
+        const value_type *found = _find(key);
+        return found == nullptr ? end() : begin() + (found - _slots.data());
+    }
+
+    const_iterator find(const Key &key) const {
+        const value_type *found = _find(key);
+        return found == nullptr ? end() : found;
+    }
+
+    bool contains(const Key &key) const {
+        return _find(key) != nullptr;
+    }
+
+    size_type count(const Key &key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    T &at(const Key &key) {
+        iterator it = find(key);
+        if (it == end()) {
+            throw std::out_of_range("StaticUnorderedMap::at");
+        }
+        return it->second;
+    }
+
+    const T &at(const Key &key) const {
+        const_iterator it = find(key);
+        if (it == end()) {
+            throw std::out_of_range("StaticUnorderedMap::at");
+        }
+        return it->second;
+    }
+};
+
+// FNV-1a, written out so it can run at compile time
+constexpr uint64_t _static_string_hash(std::string_view str) {
+    uint64_t hash = 0xCBF29CE484222325;
+    for (char c: str) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x00000100000001B3;
+    }
+    return hash;
+}
+
+/*
+    The compile-time form of StaticUnorderedMap for N string_view keys,
+    built by make_static_string_map. Everything lives in std::arrays, so a
+    constexpr StaticStringMap is placed in read-only data and its lookups
+    can run in constant expressions.
+*/
+template<typename T, size_t N>
+class StaticStringMap {
+public:
+
+    // Not a std::pair, whose assignment is only constexpr from C++20
+    struct value_type {
+        std::string_view first;
+        T second;
+    };
+
+    using size_type = size_t;
+    using const_iterator = const value_type *;
+
+    static constexpr size_type BUCKET_COUNT = _perfect_hash_bucket_count(N);
+    static constexpr size_type SLOT_COUNT = _perfect_hash_slot_count(N);
+
+private:
+
+    std::array<uint16_t, BUCKET_COUNT> _pilots{};
+    std::array<uint32_t, SLOT_COUNT - N> _remap{};
+    std::array<value_type, N> _slots{};
+    uint64_t _seed = 0;
+
+    constexpr const value_type *_find(std::string_view key) const {
+        if (N == 0) {
+            return nullptr;
+        }
+        uint64_t code = _perfect_hash_code(_static_string_hash(key), _seed);
+        size_type slot = _perfect_hash_slot(code, _pilots[_perfect_hash_bucket(code, BUCKET_COUNT)], SLOT_COUNT);
+        const value_type *candidate = &_slots[slot < N ? slot : _remap[slot - N]];
+        return candidate->first == key ? candidate : nullptr;
+    }
+
+public:
+
+    constexpr explicit StaticStringMap(const std::pair<std::string_view, T> (&pairs)[N]) {
+        std::array<uint64_t, N> codes{};
+        std::array<size_type, N> slot_of{};
+        std::array<size_type, BUCKET_COUNT + 1> bucket_start{};
+        std::array<size_type, N> members{};
+        std::array<size_type, BUCKET_COUNT> bucket_order{};
+        std::array<bool, SLOT_COUNT> taken{};
+
+        for (_seed = 0; _seed < _PERFECT_HASH_MAX_SEEDS; _seed++) {
+            for (size_type i = 0; i < N; i++) {
+                codes[i] = _perfect_hash_code(_static_string_hash(pairs[i].first), _seed);
+            }
+            if (_perfect_hash_build(codes, N, _pilots, _remap, slot_of, bucket_start, members, bucket_order, taken)) {
+                break;
+            }
+        }
+        if (_seed == _PERFECT_HASH_MAX_SEEDS) {
+            // Reached at compile time, this is the error: no perfect hash, so some keys are equal
+            throw std::invalid_argument("StaticStringMap: no perfect hash found; are the keys distinct?");
+        }
+
+        for (size_type i = 0; i < N; i++) {
+            _slots[slot_of[i]].first = pairs[i].first;
+            _slots[slot_of[i]].second = pairs[i].second;
+        }
+    }
+
+    constexpr size_type size() const {
+        return N;
+    }
+
+    constexpr const_iterator begin() const {
+        return _slots.data();
+    }
+
+    constexpr const_iterator end() const {
+        return _slots.data() + N;
+    }
+
+    // The value of key, or nullptr
+    constexpr const T *find(std::string_view key) const {
+        const value_type *found = _find(key);
+        return found == nullptr ? nullptr : &found->second;
+    }
+
+    constexpr bool contains(std::string_view key) const {
+        return _find(key) != nullptr;
+    }
+};
+
+template<typename T, size_t N>
+constexpr StaticStringMap<T, N> make_static_string_map(const std::pair<std::string_view, T> (&pairs)[N]) {
+    return StaticStringMap<T, N>(pairs);
+}
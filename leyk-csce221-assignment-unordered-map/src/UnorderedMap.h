@@ -1,10 +1,24 @@
+#pragma once
+
+#include <algorithm>  // std::fill
+#include <cmath>      // std::ceil, std::isfinite
 #include <cstddef>    // size_t
 #include <functional> // std::hash
+#include <initializer_list>
+#include <iterator>   // std::iterator_traits, std::distance
 #include <ios>
-#include <utility>    // std::pair
+#include <limits>     // std::numeric_limits
+#include <memory>     // std::allocator, std::allocator_traits
+#include <optional>   // std::optional
+#include <stdexcept>  // std::invalid_argument
+#include <tuple>      // std::forward_as_tuple
+#include <type_traits> // std::integral_constant, std::is_scalar, std::enable_if_t
+#include <utility>    // std::pair, std::piecewise_construct, std::in_place
+#include <vector>
 #include <iostream>
 
-#include "primes.h"
+#include "map_stats.h"
+#include "range_hash.h"
 
 /*
 Example implementation of UnorderedMap:
@@ -52,15 +66,52 @@ Big O Notation for operations:
   - Worst case: O(n) (when all elements hash to the same bucket)
 
 - Erase:
-  - Description: Removes an element from the map by key.
+  - Description: Removes an element from the map by key, or at an iterator. Iterators remember the node
+    before their own, so erasing at one which came from find, begin, ++ or an earlier erase, with no other
+    insert or erase since, unlinks at once; any other iterator walks its bucket to find that node.
+  - Average case: O(1)
+  - Worst case: O(n) by key (when all elements hash to the same bucket), O(1) at a fresh iterator
+
+- Erase if:
+  - Description: Removes every element a predicate accepts, in one walk down the node list.
+  - Complexity: O(n)
+
+- Find / Contains / Count:
+  - Description: Searches for an element by key. When Hash and Pred both define is_transparent (fnv1a_hash
+    with std::equal_to<>, for example) these and erase also accept other key types, such as a
+    std::string_view for a std::string key, without converting them to Key.
   - Average case: O(1)
   - Worst case: O(n) (when all elements hash to the same bucket)
 
-- Find:
-  - Description: Searches for an element by key.
+- Range construction / Insert range:
+  - Description: Builds the map from, or inserts, a range of pairs. For forward ranges the buckets are
+    sized once, every key is hashed up front and the elements are counting-sorted by bucket before they
+    are linked, so each bucket is filled in one pass and its nodes are allocated together.
+  - Average case: O(n + bucket_count) for n elements
+  - Worst case: O(n^2) (when all elements hash to the same bucket)
+
+- Emplace / Try emplace / Insert or assign:
+  - Description: Construct the new element in its node instead of copying a pair into it. try_emplace and
+    insert_or_assign look the key up first and construct nothing when it is present; emplace has to build
+    the node to learn its key.
   - Average case: O(1)
   - Worst case: O(n) (when all elements hash to the same bucket)
 
+- Extract / Insert node:
+  - Description: extract unlinks an element and returns it in a node_type handle, and insert(node_type&&)
+    links such a node into a map whose allocator compares equal. The element is never copied, moved or
+    reallocated.
+  - Average case: O(1)
+  - Worst case: O(n) (when all elements hash to the same bucket)
+
+- Find batch / Contains batch:
+  - Description: find or contains for a whole range of keys. The keys are processed in groups of 32, and
+    the bucket, node before the bucket and first node of every key in a group are prefetched stage by
+    stage, so the cache misses of a group overlap. Faster than a loop of find once the map outgrows the
+    cache; see benchmarks/find_batch.cpp.
+  - Average case: O(1) per key
+  - Worst case: O(n) per key (when all elements hash to the same bucket)
+
 - Access (operator[]):
   - Description: Accesses the element with the given key, inserting a default element if the key does not exist.
   - Average case: O(1)
@@ -75,8 +126,14 @@ Big O Notation for operations:
   - Complexity: O(1)
 
 - Clear:
-  - Description: Removes all elements from the map.
-  - Complexity: O(n)
+  - Description: Removes all elements from the map. A sparse map, with far more buckets than elements,
+    resets only the buckets its elements were in, so clearing a mostly empty map costs what its elements do.
+  - Complexity: O(n) when sparse, else O(n + bucket_count) with a single fill of the buckets
+
+- Copy construction / Copy assignment:
+  - Description: Clones other's layout: the same bucket count and node order, with cached hash codes
+    copied and each bucket set where its run of nodes starts. Keys are never looked up or compared.
+  - Complexity: O(n + bucket_count)
 
 - Bucket count:
   - Description: Returns the number of buckets in the map.
@@ -90,14 +147,61 @@ Big O Notation for operations:
   - Description: Returns the load factor of the map (number of elements divided by number of buckets).
   - Complexity: O(1)
 
+- Max load factor:
+  - Description: Returns or sets the load factor above which inserts grow the map. It is infinite by default,
+    so the map keeps the bucket count it was constructed with until a finite maximum is set. Setting zero, a
+    negative value or NaN throws std::invalid_argument.
+  - Complexity: O(1) to read, O(n + bucket_count) to set if the map has to grow
+
+- Rehash / Reserve:
+  - Description: Rebuilds the buckets with at least the requested number of buckets (rehash) or with enough
+    buckets to hold the requested number of elements (reserve). Existing nodes are relinked, not reallocated.
+  - Complexity: O(n + bucket_count)
+
+- Rehash step:
+  - Description: Returns or sets how many old buckets each insert migrates while the map grows. With the
+    default of 0 the map grows all at once. With n > 0 growing only allocates the new buckets, the old and
+    new buckets are kept side by side, and every insert after that relinks the nodes of n old buckets.
+    Finds, erases and iterators see both bucket arrays, so nothing else changes while a migration runs.
+    Choosing n >= 1 / max_load_factor() finishes each migration before the next growth starts.
+  - Complexity: O(1) to set, O(rehash_step) extra work per insert while rehashing()
+
+- Max chain length:
+  - Description: Returns or sets the chain length watchdog, off (0) by default. With a keyed hasher which has
+    reseed(), such as sip_hash, an insert which leaves more than max_chain_length() nodes in one bucket draws
+    a new key and rehashes every element into the same buckets. Keys chosen to collide under one key do not
+    collide under the next. After a reseed the watchdog waits until the map has doubled, so a map which is
+    just full is not reseeded over and over.
+  - Complexity: O(1) to set; O(max_chain_length) per insert while on, plus O(n + bucket_count) per reseed
+
 - Bucket size:
-  - Description: Returns the number of elements in a specific bucket.
+  - Description: Returns the number of elements in a specific bucket. Finishes a pending migration first.
   - Complexity: O(k) (where k is the number of elements in the bucket)
 
 - Bucket:
   - Description: Returns the bucket index for a given key.
   - Complexity: O(1)
 
+- Range hashing:
+  - Description: The RangeHash template parameter picks how hash codes become bucket indices and which
+    bucket counts are used. The default, prime_range_hash, is hash % prime. fastmod_range_hash gives the
+    same buckets without a division, and pow2_range_hash masks a mixed hash with power of two bucket
+    counts. See range_hash.h.
+  - Complexity: O(1)
+
+- Allocator:
+  - Description: Nodes and bucket arrays come from the Allocator template parameter, std::allocator by
+    default. pool_allocator (node_pool.h) serves nodes from a slab pool which recycles erased nodes, and
+    clear() hands the pool's chunks back all at once.
+  - Complexity: O(1) per node, O(chunks) for the pool's part of clear()
+
+- Statistics:
+  - Description: The Stats template parameter, after the allocator, is no_map_stats by default and counts
+    nothing. With counting_map_stats the map counts inserts, erases, lookup hits and misses, a histogram of
+    keys compared per lookup, rehashes and reseeds; stats() returns them with the longest chain right now
+    and reset_stats() zeroes them. See map_stats.h.
+  - Complexity: O(1) per operation to count, nothing when off; O(n) for stats()
+
 Example usage of iterators:
 
 #include "UnorderedMap.h"
@@ -125,16 +229,72 @@ Key: 3, Value: three
 */
 
 
-template<typename Key, typename T, typename Hash = std::hash <Key>, typename Pred = std::equal_to <Key>>
-class UnorderedMap {
+/*
+    Whether UnorderedMap stores the hash code of each key in its node. A
+    cached code costs one size_t per node; in exchange iterating, erasing
+    through an iterator and rehashing never call the hasher, and lookups only
+    compare keys whose codes are equal. It is on for every key which is not a
+    scalar (strings, pairs, ...), where hashing is not trivially cheap.
+    Specialize it to choose differently for a key and hasher.
+*/
+template<typename Key, typename Hash>
+struct cache_hash_code : std::integral_constant<bool, !std::is_scalar<Key>::value> {};
+
+/*
+    Whether F, a hasher or key comparison, marks itself transparent with a
+    nested is_transparent type, and so accepts keys other than key_type.
+    K only makes the trait depend on the key a lookup is called with.
+*/
+template<typename F, typename K, typename = void>
+struct _unordered_map_transparent : std::false_type {};
+
+template<typename F, typename K>
+struct _unordered_map_transparent<F, K, std::void_t<typename F::is_transparent>> : std::true_type {};
+
+/*
+    Whether the hasher F can draw a new key with reseed(), as sip_hash can.
+    Only maps with such a hasher can set max_chain_length.
+*/
+template<typename F, typename = void>
+struct _unordered_map_reseedable : std::false_type {};
+
+template<typename F>
+struct _unordered_map_reseedable<F, std::void_t<decltype(std::declval<F &>().reseed())>> : std::true_type {};
+
+template<bool Cached>
+struct _unordered_map_hash_code {
+    size_t code;
+};
+
+template<>
+struct _unordered_map_hash_code<false> {};
+
+/*
+    The bucket and node engine behind UnorderedMap, UnorderedSet and
+    UnorderedMultiMap. Value is what a node holds: the key itself for a set
+    (Value = Key), a std::pair<const Key, T> otherwise. With Unique false
+    equal keys may repeat; they are kept next to each other in their
+    bucket, so find returns the first of them and equal_range, count and
+    erase walk the run in one pass, and insert returns an iterator instead
+    of an (iterator, bool) pair.
+
+    Everything else, from the node list, allocator and rehash policy to the
+    watchdog and the batched lookups, is the same for the three containers.
+    The containers derive from it and add what only they have. Stats is
+    the statistics policy of map_stats.h, held as a base so that the
+    default no_map_stats takes no space.
+*/
+template<typename Key, typename Value, bool Unique, typename Hash, typename Pred, typename RangeHash,
+        typename Allocator, typename Stats>
+class _unordered_table : protected Stats {
 public:
 
     using key_type = Key;
-    using mapped_type = T;
-    using const_mapped_type = const T;
     using hasher = Hash;
     using key_equal = Pred;
-    using value_type = std::pair<const key_type, mapped_type>;
+    using range_hash = RangeHash;
+    using allocator_type = Allocator;
+    using value_type = Value;
     using reference = value_type &;
     using const_reference = const value_type &;
     using pointer = value_type *;
@@ -142,31 +302,108 @@ public:
     using size_type = size_t;
     using difference_type = ptrdiff_t;
 
-private:
+protected:
+
+    // A set's elements are its keys, which must not change in place, so all of its iterators are const
+    static constexpr bool _is_set = std::is_same<Key, Value>::value;
+
+    static constexpr bool _cache_hash_code = cache_hash_code<Key, Hash>::value;
+
+    // clear() resets buckets node by node below one element per this many buckets (see clear)
+    static constexpr size_t _clear_sparse_ratio = 8;
+
+    // The key of an element, or of anything an element is built from, such as a std::pair<Key, T> for a map
+    template<typename V>
+    static const auto &_key(const V &val) {
+        if constexpr (_is_set) {
+            return val;
+        } else {
+            return val.first;
+        }
+    }
+
+    // Enables the lookups which take a K instead of a Key when both Hash and Pred are transparent
+    template<typename K>
+    using _transparent = std::enable_if_t<_unordered_map_transparent<Hash, K>::value &&
+                                          _unordered_map_transparent<Pred, K>::value, int>;
+
+    struct HashNode;
 
-    struct HashNode {
+    /*
+        Every node of the map is threaded on one singly linked list which
+        starts at _head.next, and the nodes of each bucket are contiguous in
+        it. A bucket points to the node *before* its first node (_head for
+        the bucket at the front of the list), or is null when it is empty.
+    */
+    struct NodeBase {
         HashNode *next;
+    };
+
+    struct HashNode : NodeBase, _unordered_map_hash_code<_cache_hash_code> {
         value_type val;
 
-        HashNode(HashNode *next = nullptr) : next{next} {}
+        HashNode(HashNode *next = nullptr) : NodeBase{next} {}
+
+        HashNode(const value_type &val, HashNode *next = nullptr) : NodeBase{next}, val{val} {}
 
-        HashNode(const value_type &val, HashNode *next = nullptr) : next{next}, val{val} {}
+        HashNode(value_type &&val, HashNode *next = nullptr) : NodeBase{next}, val{std::move(val)} {}
 
-        HashNode(value_type &&val, HashNode *next = nullptr) : next{next}, val{std::move(val)} {}
+        // Constructs val in place from args
+        template<typename... Args>
+        explicit HashNode(std::in_place_t, Args &&... args) : NodeBase{nullptr}, val(std::forward<Args>(args)...) {}
     };
 
-    size_type _bucket_count;
-    HashNode **_buckets;
+    using _alloc_traits = std::allocator_traits<Allocator>;
+    using _node_allocator = typename _alloc_traits::template rebind_alloc<HashNode>;
+    using _node_alloc_traits = std::allocator_traits<_node_allocator>;
+    using _bucket_allocator = typename _alloc_traits::template rebind_alloc<NodeBase *>;
+    using _bucket_alloc_traits = std::allocator_traits<_bucket_allocator>;
+
+    // Nodes and bucket arrays are allocated through rebound copies of the map's allocator
+    _node_allocator _node_alloc;
+    _bucket_allocator _bucket_alloc;
 
-    HashNode *_head;
+    size_type _bucket_count;
+    NodeBase **_buckets;
+
+    /*
+        While an incremental rehash runs, the buckets the map grew out of are
+        kept here. Old buckets below _migrated have been moved into _buckets
+        and are empty; the others still hold their nodes.
+    */
+    size_type _old_bucket_count;
+    NodeBase **_old_buckets;
+    size_type _migrated;
+    size_type _rehash_step;
+
+    NodeBase _head;
     size_type _size;
+    float _max_load_factor;
+
+    /*
+        The chain length watchdog: when an insert leaves a bucket with more
+        than _max_chain nodes (0 turns it off), the hasher is reseeded and
+        every key rehashed. It stays quiet until the map has doubled from
+        the size of the last reseed, so reseeding costs O(1) amortized even
+        when chains are long because the map is simply full.
+    */
+    size_type _max_chain;
+    size_type _reseed_size;
+
+    /*
+        Counts the changes to the node list. An iterator remembers the node
+        before its own along with the version it saw; while the version is
+        unchanged, that node is still the one before, and erase(iterator)
+        unlinks in O(1) instead of walking the bucket to find it.
+    */
+    size_type _version;
 
     Hash _hash;
     key_equal _equal;
 
-    static size_type _range_hash(size_type hash_code, size_type bucket_count) {
-        return hash_code % bucket_count;
-    }
+    // Maps hash codes onto _buckets, and onto _old_buckets during an incremental rehash
+    RangeHash _range_hash;
+    RangeHash _old_range_hash;
 
 public:
 
@@ -181,24 +418,32 @@ public:
         using reference = value_type &;
 
     private:
-        friend class UnorderedMap<Key, T, Hash, key_equal>;
+        friend class _unordered_table;
 
-        using HashNode = typename UnorderedMap<Key, T, Hash, key_equal>::HashNode;
+        using HashNode = typename _unordered_table::HashNode;
 
-        const UnorderedMap *_map;
+        const _unordered_table *_map;
         HashNode *_ptr;
 
-        explicit basic_iterator(UnorderedMap const *map, HashNode *ptr)
+        // The node before _ptr as of list version _version, or nullptr if unknown
+        NodeBase *_prev;
+        size_type _version;
+
+        explicit basic_iterator(_unordered_table const *map, HashNode *ptr, NodeBase *prev = nullptr)
 
         noexcept {
             _map = map;
             _ptr = ptr;
+            _prev = prev;
+            _version = map->_version;
         }
 
     public:
         basic_iterator() {
             _map = nullptr;
             _ptr = nullptr;
+            _prev = nullptr;
+            _version = 0;
         };
 
         basic_iterator(const basic_iterator &) = default;
@@ -216,21 +461,8 @@ public:
         pointer operator->() const { return &(_ptr->val); }
 
         basic_iterator &operator++() {
-            if (_ptr->next != nullptr) {
-                _ptr = _ptr->next;
-                return *this;
-            }
-
-            size_type currBuc = _range_hash(_map->_hash(_ptr->val.first),
-                                            _map->_bucket_count); // Get index of current bucket
-            for (size_type currentIndex = currBuc + 1; currentIndex < _map->_bucket_count; currentIndex++) {
-                HashNode *bct = _map->_buckets[currentIndex];
-                if (bct != nullptr) {
-                    _ptr = bct;
-                    return *this;
-                }
-            }
-            _ptr = nullptr;
+            _prev = _ptr;
+            _ptr = _ptr->next;
             return *this;
         }
 
@@ -253,33 +485,40 @@ public:
         }
     };
 
-    using iterator = basic_iterator<pointer, reference, value_type>;
+    using iterator = std::conditional_t<_is_set, basic_iterator<const_pointer, const_reference, const value_type>,
+            basic_iterator<pointer, reference, value_type>>;
     using const_iterator = basic_iterator<const_pointer, const_reference, const value_type>;
 
     class local_iterator {
     public:
         using iterator_category = std::forward_iterator_tag;
-        using value_type = std::pair<const key_type, mapped_type>;
+        using value_type = std::conditional_t<_is_set, const Value, Value>;
         using difference_type = ptrdiff_t;
         using pointer = value_type *;
         using reference = value_type &;
 
     private:
-        friend class UnorderedMap<Key, T, Hash, key_equal>;
+        friend class _unordered_table;
 
-        using HashNode = typename UnorderedMap<Key, T, Hash, key_equal>::HashNode;
+        using HashNode = typename _unordered_table::HashNode;
 
         HashNode *_node;
+        const _unordered_table *_map;
+        size_type _bucket;
 
-        explicit local_iterator(HashNode *node)
+        explicit local_iterator(_unordered_table const *map, HashNode *node, size_type bucket)
 
         noexcept {
             _node = node;
+            _map = map;
+            _bucket = bucket;
         }
 
     public:
         local_iterator() {
             _node = nullptr;
+            _map = nullptr;
+            _bucket = 0;
         }
 
         local_iterator(const local_iterator &) = default;
@@ -300,12 +539,12 @@ public:
             return &(_node->val);
         }
 
+        // The bucket ends where the list reaches a node of another bucket
         local_iterator &operator++() {
-            if (_node->next == nullptr) {
+            _node = _node->next;
+            if (_node != nullptr && _map->_position(_map->_code(_node)) != _bucket) {
                 _node = nullptr;
-                return *this;
             }
-            _node = _node->next;
             return *this;
         }
 
@@ -328,154 +567,1051 @@ public:
         }
     };
 
-private:
+    /*
+        Owns a node extracted from a map. The node keeps its key and value
+        and can be inserted into any map with an equal allocator without
+        allocating, copying or moving them. An empty handle owns nothing.
+    */
+    class node_type {
+    public:
+        using key_type = Key;
+        using value_type = Value;
+        using allocator_type = Allocator;
+
+        node_type() noexcept : _node{nullptr} {}
+
+        node_type(const node_type &) = delete;
+
+        node_type(node_type &&other) noexcept : _node{other._node}, _alloc{std::move(other._alloc)} {
+            other._node = nullptr;
+            other._alloc.reset();
+        }
+
+        ~node_type() {
+            _reset();
+        }
+
+        node_type &operator=(const node_type &) = delete;
+
+        node_type &operator=(node_type &&other) noexcept {
+            if (this != &other) {
+                _reset();
+                _node = other._node;
+                _alloc = std::move(other._alloc);
+                other._node = nullptr;
+                other._alloc.reset();
+            }
+            return *this;
+        }
+
+        bool empty() const noexcept {
+            return _node == nullptr;
+        }
+
+        explicit operator bool() const noexcept {
+            return _node != nullptr;
+        }
+
+        // The key may be changed while the node is outside of any map
+        key_type &key() const {
+            return const_cast<key_type &>(_key(_node->val));
+        }
+
+        // The mapped value of a map's node; sets have none
+        template<typename V = Value>
+        auto mapped() const -> decltype((std::declval<V &>().second)) {
+            return _node->val.second;
+        }
+
+        // The whole element: the key of a set's node, the (key, value) pair of a map's
+        value_type &value() const {
+            return _node->val;
+        }
+
+        allocator_type get_allocator() const {
+            return allocator_type(*_alloc);
+        }
+
+    private:
+        friend class _unordered_table;
+
+        HashNode *_node;
+        std::optional<_node_allocator> _alloc;
+
+        node_type(HashNode *node, const _node_allocator &alloc) : _node{node}, _alloc{alloc} {}
+
+        void _reset() noexcept {
+            if (_node != nullptr) {
+                _node_alloc_traits::destroy(*_alloc, _node);
+                _node_alloc_traits::deallocate(*_alloc, _node, 1);
+                _node = nullptr;
+            }
+            _alloc.reset();
+        }
+    };
+
+    struct insert_return_type {
+        iterator position;
+        bool inserted;
+        node_type node;
+    };
+
+protected:
+
+    // What insert and emplace return: an (iterator, inserted) pair, or just the iterator when keys may repeat
+    using _insert_result = std::conditional_t<Unique, std::pair<iterator, bool>, iterator>;
+    using _node_insert_result = std::conditional_t<Unique, insert_return_type, iterator>;
+
+    _insert_result _inserted(HashNode *node, bool inserted) {
+        if constexpr (Unique) {
+            return std::make_pair(iterator(this, node), inserted);
+        } else {
+            return iterator(this, node);
+        }
+    }
+
+    // Hash code of a node's key, without calling the hasher when codes are cached.
+    size_type _code(const HashNode *node) const {
+        if constexpr (_cache_hash_code) {
+            return node->code;
+        } else {
+            return _hash(_key(node->val));
+        }
+    }
 
-    size_type _bucket(size_t code) const {
-        return _range_hash(code, _bucket_count);
+    // Whether node holds key. Cached codes are compared first, so most mismatches skip key_equal.
+    template<typename K>
+    bool _matches(const HashNode *node, size_type code, const K &key) const {
+        if constexpr (_cache_hash_code) {
+            if (node->code != code) {
+                return false;
+            }
+        }
+        return _equal(_key(node->val), key);
     }
 
-    size_type _bucket(const Key &key) const {
-        return _range_hash(_hash(key), _bucket_count);
+    /*
+        Buckets are numbered across both arrays: the buckets of _buckets come
+        first, followed by the old buckets of a running migration. Returns the
+        number of the bucket which holds (or would hold) hash code code.
+    */
+    size_type _position(size_type code) const {
+        if (_old_buckets != nullptr) {
+            size_type oldIndex = _old_range_hash(code);
+            if (oldIndex >= _migrated) {
+                return _bucket_count + oldIndex;
+            }
+        }
+        return _range_hash(code);
+    }
+
+    size_type _position_count() const {
+        return _old_buckets == nullptr ? _bucket_count : _bucket_count + _old_bucket_count;
     }
 
-    size_type _bucket(const value_type &val) const {
-        return _range_hash(_hash(val.first), _bucket_count);
+    NodeBase *&_chain(size_type position) {
+        return position < _bucket_count ? _buckets[position] : _old_buckets[position - _bucket_count];
     }
 
-    HashNode *&_find(size_type code, size_type bucket, const Key &key) {
-        HashNode **currentNode = &(_buckets[bucket]);
+    NodeBase *const &_chain(size_type position) const {
+        return position < _bucket_count ? _buckets[position] : _old_buckets[position - _bucket_count];
+    }
+
+    // Returns the node before the one holding key, or nullptr if key is not in the map.
+    template<typename K>
+    NodeBase *_find_before(size_type code, const K &key) const {
+        size_type position = _position(code);
+        NodeBase *prevNode = _chain(position);
+        size_type probes = 0;
+        if (prevNode != nullptr) {
+            for (HashNode *curNode = prevNode->next; curNode != nullptr; curNode = curNode->next) {
+                probes++;
+                if (_matches(curNode, code, key)) {
+                    Stats::on_lookup(probes, true);
+                    return prevNode;
+                }
+                if (curNode->next != nullptr && _position(_code(curNode->next)) != position) {
+                    break;
+                }
+                prevNode = curNode;
+            }
+        }
+        Stats::on_lookup(probes, false);
+        return nullptr;
+    }
 
-        while (*currentNode != nullptr) {
-            if (_equal((*currentNode)->val.first, key)) {
-                return *currentNode;
+    // Searches bucket position for key, starting at the bucket's first node curNode (nullptr if empty)
+    template<typename K>
+    HashNode *_find_in_bucket(HashNode *curNode, size_type position, size_type code, const K &key) const {
+        size_type probes = 0;
+        for (; curNode != nullptr; curNode = curNode->next) {
+            probes++;
+            if (_matches(curNode, code, key)) {
+                Stats::on_lookup(probes, true);
+                return curNode;
+            }
+            if (curNode->next != nullptr && _position(_code(curNode->next)) != position) {
+                break;
             }
-            currentNode = &((*currentNode)->next);
         }
-        return *currentNode;
+        Stats::on_lookup(probes, false);
+        return nullptr;
     }
 
-    HashNode *&_find(const Key &key) {
-        return _find(_hash(key), _bucket(key), key);
+    static constexpr size_type _BATCH_SIZE = 32;
+
+    static void _prefetch(const void *address) {
+#if defined(__GNUC__)
+        __builtin_prefetch(address);
+#else
+        (void) address;
+#endif
     }
 
-    HashNode *_insert_into_bucket(size_type bucket, value_type &&value) {
-        HashNode *bucketHead = _buckets[bucket];
-        auto *nodeToInsert = new HashNode(std::move(value));
+    /*
+        Looks up the keys of [first, last) and calls visit with the node of
+        each (nullptr if missing), in order. A lookup is three dependent
+        loads: the bucket, the node before the bucket and the bucket's first
+        node. Keys are taken _BATCH_SIZE at a time and each load is issued,
+        as a prefetch, for the whole group before any of them is used, so
+        the cache misses of the group overlap instead of queueing up.
+    */
+    template<typename KeyIt, typename Visit>
+    void _find_batch(KeyIt first, KeyIt last, Visit visit) const {
+        KeyIt keys[_BATCH_SIZE];
+        size_type codes[_BATCH_SIZE];
+        size_type positions[_BATCH_SIZE];
+        NodeBase *prevNodes[_BATCH_SIZE];
+        HashNode *nodes[_BATCH_SIZE];
+
+        while (first != last) {
+            size_type n = 0;
+            for (; n < _BATCH_SIZE && first != last; n++, ++first) {
+                keys[n] = first;
+                codes[n] = _hash(*first);
+                positions[n] = _position(codes[n]);
+                _prefetch(&_chain(positions[n]));
+            }
 
-        if (bucketHead == nullptr) {
-            nodeToInsert->next = nullptr;
-            _buckets[bucket] = nodeToInsert;
-            _size++;
+            for (size_type i = 0; i < n; i++) {
+                prevNodes[i] = _chain(positions[i]);
+                if (prevNodes[i] != nullptr) {
+                    _prefetch(prevNodes[i]);
+                }
+            }
+
+            for (size_type i = 0; i < n; i++) {
+                nodes[i] = prevNodes[i] == nullptr ? nullptr : prevNodes[i]->next;
+                if (nodes[i] != nullptr) {
+                    _prefetch(nodes[i]);
+                }
+            }
+
+            for (size_type i = 0; i < n; i++) {
+                visit(_find_in_bucket(nodes[i], positions[i], codes[i], *keys[i]));
+            }
+        }
+    }
+
+    template<typename K>
+    HashNode *_find(size_type code, const K &key) const {
+        NodeBase *prevNode = _find_before(code, key);
+        return prevNode == nullptr ? nullptr : prevNode->next;
+    }
+
+    template<typename K>
+    HashNode *_find(const K &key) const {
+        return _find(_hash(key), key);
+    }
+
+    /*
+        The node after the run of nodes holding key which starts at node.
+        Equal keys share a code and so a bucket, and a map whose keys may
+        repeat keeps them together, so the run ends at the first node which
+        does not match.
+    */
+    template<typename K>
+    HashNode *_run_end(HashNode *node, size_type code, const K &key) const {
+        if constexpr (Unique) {
+            return node->next;
+        } else {
+            while (node != nullptr && _matches(node, code, key)) {
+                node = node->next;
+            }
+            return node;
+        }
+    }
+
+    // An iterator to the (first) element with key, which knows the node before it
+    template<typename It, typename K>
+    It _find_iterator(const K &key) const {
+        NodeBase *prevNode = _find_before(_hash(key), key);
+        return prevNode == nullptr ? It(this, nullptr) : It(this, prevNode->next, prevNode);
+    }
+
+    template<typename It, typename K>
+    std::pair<It, It> _equal_range(const K &key) const {
+        size_type code = _hash(key);
+        NodeBase *prevNode = _find_before(code, key);
+        if (prevNode == nullptr) {
+            return std::make_pair(It(this, nullptr), It(this, nullptr));
+        }
+        return std::make_pair(It(this, prevNode->next, prevNode), It(this, _run_end(prevNode->next, code, key)));
+    }
+
+    template<typename K>
+    size_type _count(const K &key) const {
+        size_type code = _hash(key);
+        HashNode *node = _find(code, key);
+        if (node == nullptr) {
+            return 0;
+        }
+
+        size_type count = 0;
+        for (HashNode *end = _run_end(node, code, key); node != end; node = node->next) {
+            count++;
+        }
+        return count;
+    }
+
+    // Erases the element with key, or every element with it when keys may repeat. Returns how many it erased.
+    template<typename K>
+    size_type _erase_key(const K &key) {
+        size_type code = _hash(key);
+        NodeBase *prevNode = _find_before(code, key);
+
+        if (prevNode == nullptr) {
+            return 0;
+        }
+        size_type position = _position(code);
+        size_type erased = 0;
+        do {
+            _erase(prevNode, position);
+            erased++;
+        } while (!Unique && prevNode->next != nullptr && _matches(prevNode->next, code, key));
+        return erased;
+    }
+
+    /*
+        Links node into bucket position: right after prevNode when there is
+        one (the node before a run of keys equal to node's, which node
+        joins), else after the node before the bucket when it has nodes, or
+        at the front of the list when it is empty.
+    */
+    void _link(size_type position, HashNode *node, NodeBase *prevNode = nullptr) {
+        if (prevNode != nullptr) {
+            _version++;
+            node->next = prevNode->next;
+            prevNode->next = node;
+            return;
+        }
+        _link_run(position, node, node);
+    }
+
+    /*
+        Links the nodes first to last, already chained together, into bucket
+        position as one piece: in front of the bucket's nodes when it has
+        some, else at the front of the list. Their order is kept.
+    */
+    void _link_run(size_type position, HashNode *first, HashNode *last) {
+        _version++;
+        NodeBase *&chain = _chain(position);
+        if (chain != nullptr) {
+            last->next = chain->next;
+            chain->next = first;
+            return;
+        }
+
+        last->next = _head.next;
+        _head.next = first;
+        if (last->next != nullptr) {
+            _chain(_position(_code(last->next))) = last;
+        }
+        chain = &_head;
+    }
+
+    /*
+        Unlinks prevNode->next, a node of bucket position, keeping the buckets
+        around it pointing at the right nodes. Returns the unlinked node.
+    */
+    HashNode *_unlink(NodeBase *prevNode, size_type position) {
+        _version++;
+        HashNode *node = prevNode->next;
+        HashNode *nextNode = node->next;
+        size_type nextPosition = nextNode == nullptr ? position : _position(_code(nextNode));
+        NodeBase *&chain = _chain(position);
+
+        if (nextPosition != position) {
+            // node was the last of its bucket, so the next bucket now starts after prevNode
+            _chain(nextPosition) = prevNode;
+        }
+        if (prevNode == chain && (nextNode == nullptr || nextPosition != position)) {
+            // node was the only one in its bucket
+            chain = nullptr;
+        }
+
+        prevNode->next = nextNode;
+        return node;
+    }
+
+    template<typename InputIt>
+    static size_type _range_bucket_count(InputIt first, InputIt last, size_type bucket_count) {
+        using category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+            size_type count = static_cast<size_type>(std::distance(first, last));
+            return count > bucket_count ? count : bucket_count;
         } else {
-            nodeToInsert->next = bucketHead;
-            _buckets[bucket] = nodeToInsert;
+            return bucket_count;
+        }
+    }
+
+    /*
+        Inserts the count pairs of [first, last) in bucket order. The buckets
+        are sized for all of them once, every key is hashed up front, and a
+        counting sort on the bucket indices orders the elements so each
+        bucket is filled in one go, and the nodes of a bucket are allocated
+        next to each other. Unless keys may repeat, duplicates keep the
+        first occurrence, as with one insert after another.
+    */
+    template<typename ForwardIt>
+    void _bulk_insert(ForwardIt first, ForwardIt last, size_type count) {
+        _finish_migration();
+        if (std::isfinite(_max_load_factor) && _size + count > _max_load_factor * _bucket_count) {
+            _rehash(RangeHash::bucket_count(_min_bucket_count(_size + count)));
+        }
+
+        std::vector<ForwardIt> elements;
+        std::vector<size_type> codes;
+        std::vector<size_type> bucketStarts(_bucket_count + 1, 0);
+        elements.reserve(count);
+        codes.reserve(count);
+        for (ForwardIt it = first; it != last; ++it) {
+            size_type code = _hash(_key(*it));
+            elements.push_back(it);
+            codes.push_back(code);
+            bucketStarts[_range_hash(code) + 1]++;
+        }
+        for (size_type bucket = 0; bucket < _bucket_count; bucket++) {
+            bucketStarts[bucket + 1] += bucketStarts[bucket];
+        }
+
+        // Stable, so equal keys stay in input order
+        std::vector<size_type> order(elements.size());
+        for (size_type i = 0; i < elements.size(); i++) {
+            order[bucketStarts[_range_hash(codes[i])]++] = i;
+        }
+
+        for (size_type i: order) {
+            size_type code = codes[i];
+            NodeBase *prevNode = _find_before(code, _key(*elements[i]));
+            if (Unique && prevNode != nullptr) {
+                continue;
+            }
+
+            HashNode *node = _create_node(std::in_place, *elements[i]);
+            if constexpr (_cache_hash_code) {
+                node->code = code;
+            }
+            _link(_range_hash(code), node, prevNode);
+            _size++;
+            Stats::on_insert();
+        }
+
+        if (_max_chain != 0 && _size >= _reseed_size && _any_chain_longer_than(_max_chain)) {
+            _reseed();
+        }
+    }
+
+    template<typename... Args>
+    HashNode *_create_node(Args &&... args) {
+        HashNode *node = _node_alloc_traits::allocate(_node_alloc, 1);
+        try {
+            _node_alloc_traits::construct(_node_alloc, node, std::forward<Args>(args)...);
+        } catch (...) {
+            _node_alloc_traits::deallocate(_node_alloc, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    void _destroy_node(HashNode *node) {
+        _node_alloc_traits::destroy(_node_alloc, node);
+        _node_alloc_traits::deallocate(_node_alloc, node, 1);
+    }
+
+    NodeBase **_allocate_buckets(size_type bucket_count) {
+        NodeBase **buckets = _bucket_alloc_traits::allocate(_bucket_alloc, bucket_count);
+        std::fill(buckets, buckets + bucket_count, nullptr);
+        return buckets;
+    }
+
+    void _deallocate_buckets(NodeBase **buckets, size_type bucket_count) {
+        _bucket_alloc_traits::deallocate(_bucket_alloc, buckets, bucket_count);
+    }
+
+    // Allocators such as pool_allocator can free their memory in bulk once the map holds no nodes.
+    template<typename Alloc>
+    static auto _release(Alloc &alloc, int) -> decltype(alloc.release(), void()) {
+        alloc.release();
+    }
+
+    template<typename Alloc>
+    static void _release(Alloc &, long) {}
+
+    // Frees every node and leaves the list empty; the buckets still point at the freed nodes.
+    void _destroy_nodes() noexcept {
+        HashNode *curNode = _head.next;
+        while (curNode != nullptr) {
+            HashNode *delNode = curNode;
+            curNode = curNode->next;
+            _destroy_node(delNode);
+        }
+        _head.next = nullptr;
+    }
+
+    /*
+        Copies other's nodes into this map, which must be empty and have
+        other's bucket count. The copy keeps other's node order and bucket
+        layout, a running migration included, so each node is appended to
+        the list and a bucket is set only where a run starts: no key is
+        looked up, and cached hash codes are copied rather than recomputed.
+    */
+    void _copy_nodes(const _unordered_table &other) {
+        _range_hash = other._range_hash;
+        if (other._old_buckets != nullptr) {
+            _old_buckets = _allocate_buckets(other._old_bucket_count);
+            _old_bucket_count = other._old_bucket_count;
+            _old_range_hash = other._old_range_hash;
+            _migrated = other._migrated;
+        }
+
+        NodeBase *tail = &_head;
+        size_type tailPosition = _position_count();
+        for (const HashNode *srcNode = other._head.next; srcNode != nullptr; srcNode = srcNode->next) {
+            HashNode *node = _create_node(srcNode->val);
+            if constexpr (_cache_hash_code) {
+                node->code = srcNode->code;
+            }
+            size_type position = _position(_code(node));
+            if (position != tailPosition) {
+                _chain(position) = tail;
+                tailPosition = position;
+            }
+            tail->next = node;
+            tail = node;
             _size++;
         }
+        _version++;
+    }
+
+    // Whether bucket position holds more than limit nodes. Stops counting after limit + 1.
+    bool _chain_longer_than(size_type position, size_type limit) const {
+        NodeBase *prevNode = _chain(position);
+        if (prevNode == nullptr) {
+            return false;
+        }
+
+        size_type length = 0;
+        for (HashNode *curNode = prevNode->next; curNode != nullptr && length <= limit; curNode = curNode->next) {
+            if (_position(_code(curNode)) != position) {
+                break;
+            }
+            length++;
+        }
+        return length > limit;
+    }
+
+    // Whether any bucket holds more than limit nodes. Buckets are runs of the list, so one pass counts them all.
+    bool _any_chain_longer_than(size_type limit) const {
+        size_type length = 0;
+        size_type position = 0;
+        for (HashNode *curNode = _head.next; curNode != nullptr; curNode = curNode->next) {
+            size_type curPosition = _position(_code(curNode));
+            length = curPosition == position ? length + 1 : 1;
+            position = curPosition;
+            if (length > limit) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+        Draws a new key for the hasher and rehashes every node with it, into
+        the same number of buckets. Nodes are relinked, not reallocated.
+    */
+    void _reseed() {
+        if constexpr (_unordered_map_reseedable<Hash>::value) {
+            _finish_migration();
+            _hash.reseed();
+            Stats::on_reseed();
+            if constexpr (_cache_hash_code) {
+                for (HashNode *curNode = _head.next; curNode != nullptr; curNode = curNode->next) {
+                    curNode->code = _hash(_key(curNode->val));
+                }
+            }
+            _rehash(_bucket_count);
+            _reseed_size = 2 * _size;
+        }
+    }
+
+    /*
+        Links a newly allocated node into its bucket, next to the run of
+        equal keys after prevNode if there is one (see _link), then lets the
+        map grow and advances a running migration.
+    */
+    HashNode *_insert_node(size_type code, HashNode *node, NodeBase *prevNode = nullptr) {
+        if constexpr (_cache_hash_code) {
+            node->code = code;
+        }
+
+        size_type position = _position(code);
+        _link(position, node, prevNode);
+        _size++;
+        Stats::on_insert();
+
+        if (_max_chain != 0 && _size >= _reseed_size && _chain_longer_than(position, _max_chain)) {
+            _reseed();
+        }
+        _grow_if_needed();
+        _migrate(_rehash_step);
+        return node;
+    }
 
-        if (_head == nullptr) {
-            _head = nodeToInsert;
-        } else if (_bucket(value) <= _bucket(_head->val)) {
-            _head = nodeToInsert;
+    // Returns the node before node, which is in bucket position
+    NodeBase *_before(const HashNode *node, size_type position) const {
+        NodeBase *prevNode = _chain(position);
+        while (prevNode->next != node) {
+            prevNode = prevNode->next;
         }
-        return nodeToInsert;
+        return prevNode;
+    }
+
+    /*
+        The node before pos's node. It is the one pos remembers when pos
+        comes from this map and the list has not changed since pos was made
+        or advanced (see _version); otherwise the bucket is walked.
+    */
+    template<typename It>
+    NodeBase *_before_iterator(const It &pos, size_type position) const {
+        if (pos._prev != nullptr && pos._map == this && pos._version == _version) {
+            return pos._prev;
+        }
+        return _before(pos._ptr, position);
+    }
+
+    /*
+        Looks key up and, if it is missing, inserts a node whose value is
+        built from key and args. Nothing is allocated or constructed when
+        key is already in the map.
+    */
+    template<typename KeyArg, typename... Args>
+    std::pair<iterator, bool> _try_emplace(KeyArg &&key, Args &&... args) {
+        size_type code = _hash(key);
+        HashNode *foundNode = _find(code, key);
+        if (foundNode != nullptr) {
+            return std::make_pair(iterator(this, foundNode), false);
+        }
+
+        HashNode *node = _create_node(std::in_place, std::piecewise_construct,
+                                      std::forward_as_tuple(std::forward<KeyArg>(key)),
+                                      std::forward_as_tuple(std::forward<Args>(args)...));
+        return std::make_pair(iterator(this, _insert_node(code, node)), true);
+    }
+
+    /*
+        Inserts an element copied or moved from value. If keys are unique and
+        value's is already in the map, nothing is allocated and the element
+        found is returned instead.
+    */
+    template<typename V>
+    _insert_result _insert_value(V &&value) {
+        size_type code = _hash(_key(value));
+        NodeBase *prevNode = _find_before(code, _key(value));
+        if (Unique && prevNode != nullptr) {
+            return _inserted(prevNode->next, false);
+        }
+        return _inserted(_insert_node(code, _create_node(std::forward<V>(value)), prevNode), true);
+    }
+
+    node_type _extract(NodeBase *prevNode, size_type position) {
+        HashNode *node = _unlink(prevNode, position);
+        node->next = nullptr;
+        _size--;
+        Stats::on_erase();
+        return node_type(node, _node_alloc);
+    }
+
+    iterator _erase(NodeBase *prevNode, size_type position) {
+        HashNode *eraseNode = _unlink(prevNode, position);
+        iterator next = iterator(this, eraseNode->next, prevNode);
+        _destroy_node(eraseNode);
+        _size--;
+        Stats::on_erase();
+        return next;
     }
 
-    void _move_content(UnorderedMap &src, UnorderedMap &dst) {
+    void _move_content(_unordered_table &src, _unordered_table &dst) {
         dst._hash = std::move(src._hash);
         dst._equal = std::move(src._equal);
         dst._buckets = src._buckets;
         dst._bucket_count = src._bucket_count;
-        dst._head = src._head;
+        dst._old_buckets = src._old_buckets;
+        dst._old_bucket_count = src._old_bucket_count;
+        dst._range_hash = src._range_hash;
+        dst._old_range_hash = src._old_range_hash;
+        dst._migrated = src._migrated;
+        dst._rehash_step = src._rehash_step;
+        dst._head.next = src._head.next;
         dst._size = src._size;
-        src._head = nullptr;
-        src._buckets = new HashNode *[src._bucket_count]();
+        dst._max_load_factor = src._max_load_factor;
+        dst._max_chain = src._max_chain;
+        dst._reseed_size = src._reseed_size;
+        if (dst._head.next != nullptr) {
+            dst._chain(dst._position(dst._code(dst._head.next))) = &dst._head;
+        }
+        src._head.next = nullptr;
+        src._buckets = src._allocate_buckets(src._bucket_count);
+        src._old_buckets = nullptr;
         src._size = 0;
+        src._version++;
+
+    }
+
+    /*
+        Moves the nodes of the next count old buckets into _buckets and frees
+        the old buckets once they are all moved. Nodes are relinked, never
+        reallocated, and each stretch of them bound for one new bucket moves
+        as a piece, so equal keys keep their order.
+    */
+    void _migrate(size_type count) {
+        if (_old_buckets == nullptr || count == 0) {
+            return;
+        }
+
+        for (; count > 0 && _migrated < _old_bucket_count; count--) {
+            size_type position = _bucket_count + _migrated;
+            NodeBase *prevNode = _old_buckets[_migrated];
+            if (prevNode == nullptr) {
+                _migrated++;
+                continue;
+            }
+
+            // Cut the bucket's run of nodes out of the list
+            HashNode *first = prevNode->next;
+            HashNode *last = first;
+            while (last->next != nullptr && _position(_code(last->next)) == position) {
+                last = last->next;
+            }
+            HashNode *after = last->next;
+            last->next = nullptr;
+            prevNode->next = after;
+            if (after != nullptr) {
+                _chain(_position(_code(after))) = prevNode;
+            }
+            _old_buckets[_migrated] = nullptr;
+            _migrated++;
+
+            while (first != nullptr) {
+                size_type newPosition = _range_hash(_code(first));
+                HashNode *stretchLast = first;
+                while (stretchLast->next != nullptr && _range_hash(_code(stretchLast->next)) == newPosition) {
+                    stretchLast = stretchLast->next;
+                }
+                HashNode *nextNode = stretchLast->next;
+                _link_run(newPosition, first, stretchLast);
+                first = nextNode;
+            }
+        }
+
+        if (_migrated == _old_bucket_count) {
+            _deallocate_buckets(_old_buckets, _old_bucket_count);
+            _old_buckets = nullptr;
+        }
+    }
+
+    void _finish_migration() {
+        _migrate(std::numeric_limits<size_type>::max());
+    }
+
+    /*
+        Relinks every node into a new array of bucket_count buckets. Nodes are
+        never reallocated, so iterators, pointers and references to elements
+        stay valid. Each stretch of nodes bound for one new bucket moves as a
+        piece, so equal keys, which are always next to each other, keep their
+        order.
+    */
+    void _rehash(size_type bucket_count) {
+        _finish_migration();
+        _version++;
+        Stats::on_rehash();
+        NodeBase **newBuckets = _allocate_buckets(bucket_count);
+        RangeHash newRangeHash(bucket_count);
+
+        HashNode *curNode = _head.next;
+        _head.next = nullptr;
+        size_type newIndex = curNode == nullptr ? 0 : newRangeHash(_code(curNode));
+        size_type frontBucket = 0;
+        while (curNode != nullptr) {
+            HashNode *lastNode = curNode;
+            size_type nextIndex = 0;
+            while (lastNode->next != nullptr) {
+                nextIndex = newRangeHash(_code(lastNode->next));
+                if (nextIndex != newIndex) {
+                    break;
+                }
+                lastNode = lastNode->next;
+            }
+            HashNode *nextNode = lastNode->next;
+
+            if (newBuckets[newIndex] == nullptr) {
+                // First stretch of its bucket: it goes to the front of the list
+                lastNode->next = _head.next;
+                _head.next = curNode;
+                newBuckets[newIndex] = &_head;
+                if (lastNode->next != nullptr) {
+                    newBuckets[frontBucket] = lastNode;
+                }
+                frontBucket = newIndex;
+            } else {
+                lastNode->next = newBuckets[newIndex]->next;
+                newBuckets[newIndex]->next = curNode;
+            }
+            curNode = nextNode;
+            newIndex = nextIndex;
+        }
+
+        _deallocate_buckets(_buckets, _bucket_count);
+        _buckets = newBuckets;
+        _bucket_count = bucket_count;
+        _range_hash = newRangeHash;
+    }
+
+    /*
+        Starts an incremental rehash into bucket_count buckets. Only the new
+        bucket array is allocated here; later inserts move the nodes over.
+    */
+    void _start_migration(size_type bucket_count) {
+        _finish_migration();
+        Stats::on_rehash();
+        _old_buckets = _buckets;
+        _old_bucket_count = _bucket_count;
+        _old_range_hash = _range_hash;
+        _migrated = 0;
+        _buckets = _allocate_buckets(bucket_count);
+        _bucket_count = bucket_count;
+        _range_hash = RangeHash(bucket_count);
+    }
 
+    // Smallest bucket count which holds count elements without exceeding the maximum load factor.
+    size_type _min_bucket_count(size_type count) const {
+        return static_cast<size_type>(std::ceil(count / _max_load_factor));
+    }
+
+    /*
+        Called after an insert. Grows to at least twice the buckets once the
+        load factor exceeds the maximum, so the cost of relinking is amortized
+        over the inserts which filled the old buckets.
+    */
+    void _grow_if_needed() {
+        if (_size > _max_load_factor * _bucket_count) {
+            size_type doubled = 2 * _bucket_count;
+            size_type needed = _min_bucket_count(_size);
+            size_type newBucketCount = RangeHash::bucket_count(needed > doubled ? needed : doubled);
+            if (_rehash_step == 0) {
+                _rehash(newBucketCount);
+            } else {
+                _start_migration(newBucketCount);
+            }
+        }
     }
 
 public:
-    explicit UnorderedMap(size_type bucket_count, const Hash &hash = Hash{},
-                          const key_equal &equal = key_equal{}) {
-        _head = nullptr;
-        _bucket_count = next_greater_prime(bucket_count);
-        _buckets = new HashNode *[_bucket_count]();
+    explicit _unordered_table(size_type bucket_count, const Hash &hash = Hash{},
+                          const key_equal &equal = key_equal{}, const allocator_type &alloc = allocator_type{})
+            : _node_alloc{alloc}, _bucket_alloc{alloc},
+              _max_load_factor{std::numeric_limits<float>::infinity()}, _hash{hash}, _equal{equal} {
+        _head.next = nullptr;
+        _bucket_count = RangeHash::bucket_count(bucket_count);
+        _buckets = _allocate_buckets(_bucket_count);
+        _range_hash = RangeHash(_bucket_count);
+        _old_buckets = nullptr;
+        _old_bucket_count = 0;
+        _migrated = 0;
+        _rehash_step = 0;
         _size = 0;
+        _max_chain = 0;
+        _reseed_size = 0;
+        _version = 0;
+    }
+
+    /*
+        Builds the map from the pairs in [first, last). Unless bucket_count
+        asks for more, forward ranges get one bucket per element, so the
+        load factor starts at 1 or below.
+    */
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    _unordered_table(InputIt first, InputIt last, size_type bucket_count = 0, const Hash &hash = Hash{},
+                 const key_equal &equal = key_equal{}, const allocator_type &alloc = allocator_type{})
+            : _unordered_table(_range_bucket_count(first, last, bucket_count), hash, equal, alloc) {
+        insert(first, last);
     }
 
-    ~UnorderedMap() {
-        clear();
-        delete[] _buckets;
+    _unordered_table(std::initializer_list<value_type> init, size_type bucket_count = 0, const Hash &hash = Hash{},
+                 const key_equal &equal = key_equal{}, const allocator_type &alloc = allocator_type{})
+            : _unordered_table(init.begin(), init.end(), bucket_count, hash, equal, alloc) {}
+
+    ~_unordered_table() {
+        _destroy_nodes();
+        if (_old_buckets != nullptr) {
+            _deallocate_buckets(_old_buckets, _old_bucket_count);
+        }
+        _deallocate_buckets(_buckets, _bucket_count);
         _bucket_count = 0;
         _buckets = nullptr;
         _size = 0;
     }
 
-    UnorderedMap(const UnorderedMap &other) {
+    _unordered_table(const _unordered_table &other)
+            : _node_alloc{_alloc_traits::select_on_container_copy_construction(other.get_allocator())},
+              _bucket_alloc{_node_alloc},
+              _max_load_factor{other._max_load_factor}, _hash{other._hash}, _equal{other._equal} {
         _bucket_count = other._bucket_count;
-        _buckets = new HashNode *[_bucket_count]();
-        _head = nullptr;
+        _buckets = _allocate_buckets(_bucket_count);
+        _range_hash = other._range_hash;
+        _old_buckets = nullptr;
+        _old_bucket_count = 0;
+        _migrated = 0;
+        _rehash_step = other._rehash_step;
+        _max_chain = other._max_chain;
+        _reseed_size = other._reseed_size;
+        _version = 0;
+        _head.next = nullptr;
         _size = 0;
-        _hash = other._hash;
-        _equal = other._equal;
 
-        for (size_type bucketIndex = 0; bucketIndex < other._bucket_count; bucketIndex++) {
-            HashNode *curNode = other._buckets[bucketIndex];
-            while (curNode != nullptr) {
-                insert(curNode->val);
-                curNode = curNode->next;
-            }
+        try {
+            _copy_nodes(other);
+        } catch (...) {
+            clear();
+            _deallocate_buckets(_buckets, _bucket_count);
+            throw;
         }
     }
 
-    UnorderedMap(UnorderedMap &&other) {
+    _unordered_table(_unordered_table &&other)
+            : _node_alloc{other._node_alloc}, _bucket_alloc{other._bucket_alloc},
+              _version{0}, _hash{other._hash}, _equal{other._equal} {
         _move_content(other, *this);
     }
 
-    UnorderedMap &operator=(const UnorderedMap &other) {
+    /*
+        The new bucket array is allocated before the old one is freed, from
+        the allocator the map will have afterwards, so a failed allocation
+        leaves an empty map with its own buckets.
+    */
+    _unordered_table &operator=(const _unordered_table &other) {
         if (this != &other) {
-            this->~UnorderedMap();
+            clear();
+            _bucket_allocator bucketAlloc = _bucket_alloc;
+            if constexpr (_alloc_traits::propagate_on_container_copy_assignment::value) {
+                bucketAlloc = other._bucket_alloc;
+            }
+            NodeBase **newBuckets = _bucket_alloc_traits::allocate(bucketAlloc, other._bucket_count);
+            std::fill(newBuckets, newBuckets + other._bucket_count, nullptr);
+
+            _deallocate_buckets(_buckets, _bucket_count);
+            if constexpr (_alloc_traits::propagate_on_container_copy_assignment::value) {
+                _node_alloc = other._node_alloc;
+                _bucket_alloc = other._bucket_alloc;
+            }
+            _buckets = newBuckets;
             _bucket_count = other._bucket_count;
-            _buckets = new HashNode *[_bucket_count]();
-            _head = nullptr;
-            _size = 0;
+            _rehash_step = other._rehash_step;
+            _max_chain = other._max_chain;
+            _reseed_size = other._reseed_size;
+            _max_load_factor = other._max_load_factor;
             _hash = other._hash;
             _equal = other._equal;
+            static_cast<Stats &>(*this) = Stats{};
 
-            for (size_type bucketIndex = 0; bucketIndex < other._bucket_count; bucketIndex++) {
-                HashNode *curNode = other._buckets[bucketIndex];
-                while (curNode != nullptr) {
-                    insert(curNode->val);
-                    curNode = curNode->next;
-                }
+            try {
+                _copy_nodes(other);
+            } catch (...) {
+                clear();
+                throw;
             }
         }
         return *this;
     }
 
-    UnorderedMap &operator=(UnorderedMap &&other) {
+    /*
+        Takes other's nodes when its allocator comes along (or is equal to
+        ours); otherwise the nodes belong to other's allocator, so the
+        elements are moved into new nodes one by one.
+    */
+    _unordered_table &operator=(_unordered_table &&other) {
         if (this != &other) {
-            this->~UnorderedMap();
+            clear();
+            if constexpr (!_alloc_traits::propagate_on_container_move_assignment::value) {
+                if (_node_alloc != other._node_alloc) {
+                    _max_load_factor = other._max_load_factor;
+                    _rehash_step = other._rehash_step;
+                    _max_chain = other._max_chain;
+                    _reseed_size = other._reseed_size;
+                    _hash = other._hash;
+                    _equal = other._equal;
+                    for (iterator it = other.begin(); it != other.end(); it++) {
+                        insert(std::move(*it));
+                    }
+                    other.clear();
+                    static_cast<Stats &>(*this) = Stats{};
+                    return *this;
+                }
+            }
+            _deallocate_buckets(_buckets, _bucket_count);
+            _node_alloc = other._node_alloc;
+            _bucket_alloc = other._bucket_alloc;
             _move_content(other, *this);
+            static_cast<Stats &>(*this) = Stats{};
         }
         return *this;
     }
 
+    allocator_type get_allocator() const {
+        return allocator_type(_node_alloc);
+    }
+
+    /*
+        Frees the nodes and empties the buckets. When the map is sparse,
+        with under one element per _clear_sparse_ratio buckets, only the
+        buckets of the nodes are reset, as each is freed, so the cost
+        follows the elements and not the bucket count; otherwise the bucket
+        array is filled in one sweep, which is cheaper than a store per node.
+    */
     void clear()
 
     noexcept {
-        if (_size > 0) {
-            for (size_type index = 0; index < _bucket_count; index++) {
-                HashNode *curNode = _buckets[index];
-                if (curNode != nullptr) {
-                    while (curNode != nullptr) {
-                        HashNode *delNode = curNode;
-                        curNode = curNode->next;
-                        delete delNode;
-                        _size--;
-                    }
-                }
+        if (_size > 0 && _size < _bucket_count / _clear_sparse_ratio) {
+            HashNode *curNode = _head.next;
+            while (curNode != nullptr) {
+                HashNode *delNode = curNode;
+                curNode = curNode->next;
+                _chain(_position(_code(delNode))) = nullptr;
+                _destroy_node(delNode);
             }
+            _head.next = nullptr;
+        } else if (_size > 0) {
+            _destroy_nodes();
+            std::fill(_buckets, _buckets + _bucket_count, nullptr);
         }
+
+        if (_old_buckets != nullptr) {
+            _deallocate_buckets(_old_buckets, _old_bucket_count);
+            _old_buckets = nullptr;
+        }
+        _size = 0;
+        _version++;
+        _release(_node_alloc, 0);
     }
 
     size_type size() const
@@ -497,7 +1633,7 @@ public:
     }
 
     iterator begin() {
-        return iterator(this, _head);
+        return iterator(this, _head.next, &_head);
     }
 
     iterator end() {
@@ -505,28 +1641,27 @@ public:
     }
 
     const_iterator cbegin() const {
-        return const_iterator(this, _head);
+        return const_iterator(this, _head.next, const_cast<NodeBase *>(&_head));
     };
 
     const_iterator cend() const {
         return const_iterator(this, nullptr);
     };
 
+    // Finishes a pending migration so bucket n holds every element bucket() maps to it.
     local_iterator begin(size_type n) {
-        return local_iterator(_buckets[n]);
+        _finish_migration();
+        return local_iterator(this, _buckets[n] == nullptr ? nullptr : _buckets[n]->next, n);
     }
 
     local_iterator end(size_type n) {
-        return local_iterator(nullptr);
+        return local_iterator(this, nullptr, n);
     }
 
     size_type bucket_size(size_type n) {
         size_type count = 0;
-        HashNode *curNode = _buckets[n];
-
-        while (curNode != nullptr) {
+        for (local_iterator it = begin(n); it != end(n); it++) {
             count++;
-            curNode = curNode->next;
         }
         return count;
     }
@@ -535,133 +1670,392 @@ public:
         return ((float) _size) / _bucket_count;
     }
 
-    size_type bucket(const Key &key) const {
-        return _bucket(key);
+    float max_load_factor() const {
+        return _max_load_factor;
     }
 
-    std::pair<iterator, bool> insert(value_type &&value) {
-        HashNode *duplicateCand = _find(value.first);
+    /*
+        Sets the load factor above which inserts grow the map and grows it
+        right away if it is already over. Pass infinity to go back to a fixed
+        bucket count; zero, negative values and NaN throw std::invalid_argument.
+    */
+    void max_load_factor(float ml) {
+        if (!(ml > 0.0f)) {
+            throw std::invalid_argument("max_load_factor must be positive");
+        }
+        _max_load_factor = ml;
+        _grow_if_needed();
+    }
 
-        if (duplicateCand == nullptr) {
-            return std::make_pair(iterator(this, _insert_into_bucket(_bucket(value), std::move(value))), true);
+    size_type rehash_step() const {
+        return _rehash_step;
+    }
+
+    /*
+        Sets how many old buckets each insert moves while the map grows
+        incrementally. 0 grows the map all at once, which also finishes a
+        pending migration right away.
+    */
+    void rehash_step(size_type step) {
+        _rehash_step = step;
+        if (_rehash_step == 0) {
+            _finish_migration();
         }
-        return std::make_pair(iterator(this, duplicateCand), false);
     }
 
-    std::pair<iterator, bool> insert(const value_type &value) {
-        HashNode *duplicateCand = _find(value.first);
+    // Whether an incremental rehash is still moving nodes out of the old buckets.
+    bool rehashing() const {
+        return _old_buckets != nullptr;
+    }
 
-        if (duplicateCand == nullptr) {
-            HashNode *bucketHead = _buckets[_bucket(value)];
-            auto *nodeToInsert = new HashNode(value);
+    size_type max_chain_length() const {
+        return _max_chain;
+    }
 
-            if (bucketHead == nullptr) {
-                nodeToInsert->next = nullptr;
-                _buckets[_bucket(value)] = nodeToInsert;
-                _size++;
-            } else {
-                nodeToInsert->next = bucketHead;
-                _buckets[_bucket(value)] = nodeToInsert;
-                _size++;
-            }
+    /*
+        Turns on the chain length watchdog: an insert which leaves more than
+        length nodes in a bucket reseeds the hasher and rehashes the map.
+        0 turns it off. Needs a hasher with reseed(), such as sip_hash.
+    */
+    void max_chain_length(size_type length) {
+        static_assert(_unordered_map_reseedable<Hash>::value, "max_chain_length needs a hasher with reseed()");
+        _max_chain = length;
+    }
 
-            if (_head == nullptr) {
-                _head = nodeToInsert;
-            } else if (_bucket(value) <= _bucket(_head->val)) {
-                _head = nodeToInsert;
+    /*
+        The counters of a map with counting_map_stats (see map_stats.h),
+        with max_chain set to the longest bucket in the map right now.
+    */
+    map_stats stats() const {
+        static_assert(Stats::enabled, "stats() needs a statistics policy such as counting_map_stats");
+        map_stats snapshot = Stats::snapshot();
+        size_type length = 0;
+        size_type position = 0;
+        for (HashNode *curNode = _head.next; curNode != nullptr; curNode = curNode->next) {
+            size_type curPosition = _position(_code(curNode));
+            length = curPosition == position ? length + 1 : 1;
+            position = curPosition;
+            if (length > snapshot.max_chain) {
+                snapshot.max_chain = length;
             }
-            return std::make_pair(iterator(this, nodeToInsert), true);
         }
+        return snapshot;
+    }
+
+    void reset_stats() {
+        static_assert(Stats::enabled, "reset_stats() needs a statistics policy such as counting_map_stats");
+        Stats::reset();
+    }
+
+    hasher hash_function() const {
+        return _hash;
+    }
+
+    key_equal key_eq() const {
+        return _equal;
+    }
+
+    /*
+        Sets the bucket count to the smallest one RangeHash allows (the next
+        prime by default) which is at least count and large enough to keep
+        load_factor() <= max_load_factor().
+    */
+    void rehash(size_type count) {
+        size_type needed = _min_bucket_count(_size);
+        size_type newBucketCount = RangeHash::bucket_count(count > needed ? count : needed);
+        if (newBucketCount != _bucket_count) {
+            _rehash(newBucketCount);
+        }
+    }
 
-        return std::make_pair(iterator(this, duplicateCand), false);
+    /*
+        Pre-sizes the buckets for count elements. With the default (infinite)
+        maximum load factor this sizes for one element per bucket.
+    */
+    void reserve(size_type count) {
+        float ml = std::isfinite(_max_load_factor) ? _max_load_factor : 1.0f;
+        rehash(static_cast<size_type>(std::ceil(count / ml)));
+    }
 
+    size_type bucket(const Key &key) const {
+        return _range_hash(_hash(key));
     }
 
-    iterator find(const Key &key) { return iterator(this, _find(key)); }
+    _insert_result insert(value_type &&value) {
+        return _insert_value(std::move(value));
+    }
 
-    T &operator[](const Key &key) {
-        HashNode *foundNode = _find(key);
-        if (foundNode == nullptr) {
-            auto *insertNde = new HashNode(std::make_pair(key, T{}), nullptr);
-            size_type idx = _bucket(key);
-            insertNde->next = _buckets[idx];
-            _buckets[idx] = insertNde;
-            _size++;
+    _insert_result insert(const value_type &value) {
+        return _insert_value(value);
+    }
 
-            if (_head == nullptr) {
-                _head = insertNde;
-            } else if (_bucket(insertNde->val) <= _bucket(_head->val)) {
-                _head = insertNde;
+    /*
+        Inserts every element of [first, last), skipping those whose key is
+        in the map already unless keys may repeat. Ranges with at least a
+        quarter as many elements as there are buckets take the bulk path
+        (see _bulk_insert); anything smaller, and input iterators, which can
+        only be read once, insert one element at a time.
+    */
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void insert(InputIt first, InputIt last) {
+        using category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+            size_type count = static_cast<size_type>(std::distance(first, last));
+            if (count > 0 && 4 * count >= _bucket_count) {
+                _bulk_insert(first, last, count);
+                return;
             }
-            return insertNde->val.second;
         }
-        return foundNode->val.second;
+        for (; first != last; ++first) {
+            insert(*first);
+        }
     }
 
-    iterator erase(iterator pos) {
-        if (pos == end()) {
-            return end();
+    void insert(std::initializer_list<value_type> init) {
+        insert(init.begin(), init.end());
+    }
+
+    iterator find(const Key &key) { return _find_iterator<iterator>(key); }
+
+    const_iterator find(const Key &key) const { return _find_iterator<const_iterator>(key); }
+
+    /*
+        With a transparent Hash and Pred (such as fnv1a_hash and std::equal_to<>)
+        find, contains, count, equal_range and erase also take any key the two
+        accept, so a std::string keyed map can be searched with a
+        std::string_view or a C string without building a std::string.
+    */
+    template<typename K, _transparent<K> = 0>
+    iterator find(const K &key) { return _find_iterator<iterator>(key); }
+
+    template<typename K, _transparent<K> = 0>
+    const_iterator find(const K &key) const { return _find_iterator<const_iterator>(key); }
+
+    bool contains(const Key &key) const { return _find(key) != nullptr; }
+
+    template<typename K, _transparent<K> = 0>
+    bool contains(const K &key) const { return _find(key) != nullptr; }
+
+    size_type count(const Key &key) const { return _count(key); }
+
+    template<typename K, _transparent<K> = 0>
+    size_type count(const K &key) const { return _count(key); }
+
+    // The elements with key, found in one pass since equal keys are next to each other
+    std::pair<iterator, iterator> equal_range(const Key &key) {
+        return _equal_range<iterator>(key);
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const Key &key) const {
+        return _equal_range<const_iterator>(key);
+    }
+
+    template<typename K, _transparent<K> = 0>
+    std::pair<iterator, iterator> equal_range(const K &key) {
+        return _equal_range<iterator>(key);
+    }
+
+    template<typename K, _transparent<K> = 0>
+    std::pair<const_iterator, const_iterator> equal_range(const K &key) const {
+        return _equal_range<const_iterator>(key);
+    }
+
+    /*
+        Builds the element in its node from args. The key is only known once
+        the node exists, so with unique keys a duplicate costs one node which
+        is freed again; a map's try_emplace avoids that when the key is at
+        hand.
+    */
+    template<typename... Args>
+    _insert_result emplace(Args &&... args) {
+        HashNode *node = _create_node(std::in_place, std::forward<Args>(args)...);
+        size_type code;
+        NodeBase *prevNode;
+        try {
+            code = _hash(_key(node->val));
+            prevNode = _find_before(code, _key(node->val));
+        } catch (...) {
+            _destroy_node(node);
+            throw;
         }
 
-        HashNode *eraseNode = pos._ptr;
-        size_type idx = _bucket(pos._ptr->val);
-        HashNode *curNode = _buckets[idx];
+        if (Unique && prevNode != nullptr) {
+            _destroy_node(node);
+            return _inserted(prevNode->next, false);
+        }
+        return _inserted(_insert_node(code, node, prevNode), true);
+    }
 
-        if (eraseNode == curNode) {
-            auto it = iterator(this, eraseNode);
-            it++;
-            _buckets[idx] = eraseNode->next;
-            if (eraseNode == _head) {
-                _head = it._ptr;
+    /*
+        Links the node owned by nh into the map. With unique keys a node
+        whose key is already there is handed back in the result instead.
+        nh's allocator must compare equal to the map's.
+    */
+    _node_insert_result insert(node_type &&nh) {
+        if (nh.empty()) {
+            if constexpr (Unique) {
+                return insert_return_type{end(), false, node_type()};
+            } else {
+                return end();
             }
-            delete eraseNode;
-            _size--;
-            return it;
         }
 
-        while (curNode != nullptr) {
-            if (curNode->next == eraseNode) {
-                auto it = iterator(this, eraseNode);
-                it++;
-                curNode->next = eraseNode->next;
-                delete eraseNode;
-                _size--;
-                return it;
+        size_type code = _hash(_key(nh._node->val));
+        NodeBase *prevNode = _find_before(code, _key(nh._node->val));
+        if constexpr (Unique) {
+            if (prevNode != nullptr) {
+                return insert_return_type{iterator(this, prevNode->next), false, std::move(nh)};
             }
-            curNode = curNode->next;
         }
 
-        return end();
+        HashNode *inserted = _insert_node(code, nh._node, prevNode);
+        nh._node = nullptr;
+        nh._alloc.reset();
+        if constexpr (Unique) {
+            return insert_return_type{iterator(this, inserted), true, node_type()};
+        } else {
+            return iterator(this, inserted);
+        }
+    }
+
+    // Unlinks the element at pos without destroying it. pos must be dereferenceable.
+    node_type extract(iterator pos) {
+        size_type position = _position(_code(pos._ptr));
+        return _extract(_before_iterator(pos, position), position);
+    }
+
+    // Unlinks the (first) element with key, or returns an empty handle if there is none
+    node_type extract(const Key &key) {
+        size_type code = _hash(key);
+        NodeBase *prevNode = _find_before(code, key);
+        if (prevNode == nullptr) {
+            return node_type();
+        }
+        return _extract(prevNode, _position(code));
+    }
+
+    /*
+        Writes find(key) for every key of the forward range [first, last) to
+        out, in order, and returns the end of the output. The keys may be of
+        any type find accepts. Lookups are batched and prefetched (see
+        _find_batch), which pays off once the map no longer fits in cache.
+    */
+    template<typename KeyIt, typename OutputIt>
+    OutputIt find_batch(KeyIt first, KeyIt last, OutputIt out) {
+        _find_batch(first, last, [&](HashNode *node) { *out++ = iterator(this, node); });
+        return out;
+    }
+
+    template<typename KeyIt, typename OutputIt>
+    OutputIt find_batch(KeyIt first, KeyIt last, OutputIt out) const {
+        _find_batch(first, last, [&](HashNode *node) { *out++ = const_iterator(this, node); });
+        return out;
+    }
 
+    // Writes contains(key) for every key of [first, last) to out, batched like find_batch
+    template<typename KeyIt, typename OutputIt>
+    OutputIt contains_batch(KeyIt first, KeyIt last, OutputIt out) const {
+        _find_batch(first, last, [&](HashNode *node) { *out++ = node != nullptr; });
+        return out;
+    }
+
+    iterator erase(iterator pos) {
+        if (pos == end()) {
+            return end();
+        }
+
+        size_type position = _position(_code(pos._ptr));
+        return _erase(_before_iterator(pos, position), position);
     }
 
     size_type erase(const Key &key) {
-        size_type bucketIndex = _bucket(key);
-        HashNode *currentNode = _buckets[bucketIndex];
-
-        if (_equal(key, currentNode->val.first)) {
-            auto it = iterator(this, currentNode);
-            it++;
-            _buckets[bucketIndex] = currentNode->next;
-            if (_head == currentNode) {
-                _head = it._ptr;
-            }
-            delete currentNode;
-            _size--;
-            return 1;
-        }
-
-        while (currentNode->next != nullptr) {
-            if (_equal(key, currentNode->next->val.first)) {
-                HashNode *eraseNode = currentNode->next;
-                currentNode->next = eraseNode->next;
-                delete eraseNode;
+        return _erase_key(key);
+    }
+
+    /*
+        Erases every element for which pred(element) is true and returns
+        how many it erased. It is one walk down the node list: the walk
+        holds the node before each element, so an element is unlinked
+        right there and no bucket is searched.
+    */
+    template<typename Predicate>
+    size_type erase_if(Predicate pred) {
+        size_type erased = 0;
+        NodeBase *prevNode = &_head;
+        while (prevNode->next != nullptr) {
+            HashNode *node = prevNode->next;
+            if (pred(static_cast<const value_type &>(node->val))) {
+                _destroy_node(_unlink(prevNode, _position(_code(node))));
                 _size--;
-                return 1;
+                Stats::on_erase();
+                erased++;
+            } else {
+                prevNode = node;
             }
-            currentNode = currentNode->next;
         }
-        return 0;
+        return erased;
+    }
+
+    // Iterators go to erase(iterator), whatever Hash and Pred accept
+    template<typename K, _transparent<K> = 0,
+             std::enable_if_t<!std::is_convertible<K, iterator>::value &&
+                              !std::is_convertible<K, const_iterator>::value, int> = 0>
+    size_type erase(K &&key) {
+        return _erase_key(key);
+    }
+};
+
+template<typename Key, typename T, typename Hash = std::hash <Key>, typename Pred = std::equal_to <Key>,
+        typename RangeHash = prime_range_hash, typename Allocator = std::allocator<std::pair<const Key, T>>,
+        typename Stats = no_map_stats>
+class UnorderedMap
+        : public _unordered_table<Key, std::pair<const Key, T>, true, Hash, Pred, RangeHash, Allocator, Stats> {
+    using _table = _unordered_table<Key, std::pair<const Key, T>, true, Hash, Pred, RangeHash, Allocator, Stats>;
+
+public:
+
+    using mapped_type = T;
+    using const_mapped_type = const T;
+    using typename _table::iterator;
+
+    using _table::_table;
+
+    // Inserts (key, T(args...)) if key is missing. Neither allocates nor constructs anything otherwise.
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key &key, Args &&... args) {
+        return this->_try_emplace(key, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(Key &&key, Args &&... args) {
+        return this->_try_emplace(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // Inserts (key, obj) if key is missing, and assigns obj to its value otherwise
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key &key, M &&obj) {
+        std::pair<iterator, bool> result = this->_try_emplace(key, std::forward<M>(obj));
+        if (!result.second) {
+            result.first->second = std::forward<M>(obj);
+        }
+        return result;
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(Key &&key, M &&obj) {
+        std::pair<iterator, bool> result = this->_try_emplace(std::move(key), std::forward<M>(obj));
+        if (!result.second) {
+            result.first->second = std::forward<M>(obj);
+        }
+        return result;
+    }
+
+    T &operator[](const Key &key) {
+        return this->_try_emplace(key).first->second;
+    }
+
+    T &operator[](Key &&key) {
+        return this->_try_emplace(std::move(key)).first->second;
     }
 
     template<typename KK, typename VV>
@@ -673,14 +2067,17 @@ void print_map(const UnorderedMap<K, V> &map, std::ostream &os = std::cout) {
     using size_type = typename UnorderedMap<K, V>::size_type;
     using HashNode = typename UnorderedMap<K, V>::HashNode;
 
+    // Nodes are printed by bucket; nodes still in old buckets go with the bucket they will move to
+    std::vector<std::vector<HashNode const *>> buckets(map.bucket_count());
+    for (HashNode const *node = map._head.next; node; node = node->next) {
+        buckets[map._range_hash(map._code(node))].push_back(node);
+    }
+
     for (size_type bucket = 0; bucket < map.bucket_count(); bucket++) {
         os << bucket << ": ";
 
-        HashNode const *node = map._buckets[bucket];
-
-        while (node) {
+        for (HashNode const *node : buckets[bucket]) {
             os << "(" << node->val.first << ", " << node->val.second << ") ";
-            node = node->next;
         }
 
         os << std::endl;
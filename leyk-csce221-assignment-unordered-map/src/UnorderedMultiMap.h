@@ -0,0 +1,94 @@
+#pragma once
+
+#include <functional> // std::hash, std::equal_to
+#include <memory>     // std::allocator
+#include <utility>    // std::pair
+
+#include "UnorderedMap.h"
+
+/*
+UnorderedMultiMap is an UnorderedMap in which a key may appear any number of
+times. It runs on the same engine (_unordered_table) as UnorderedMap and
+UnorderedSet, with the same node list, allocator support, range hashing and
+rehash policy.
+
+Elements with equal keys are kept next to each other in their bucket: an
+insert links the new element just before the first one with its key, and
+rehashing and incremental migration move each stretch of nodes bound for
+one new bucket as a piece, so the run stays together and keeps its order,
+as std::unordered_multimap's rehash does. find
+returns the first element of the run, and equal_range, count and erase(key)
+walk it in one pass, stopping at the first node with another key.
+
+insert and emplace always insert, so they return an iterator to the new
+element rather than an (iterator, bool) pair, and insert(node_type&&) does
+too. There is no operator[], try_emplace or insert_or_assign, which only
+make sense with one element per key. The chain length watchdog counts every
+node of a bucket, equal keys included, which a new hash seed cannot split.
+
+Example usage:
+
+#include "UnorderedMultiMap.h"
+#include <iostream>
+#include <string>
+
+int main() {
+    UnorderedMultiMap<std::string, int> scores(16);
+    scores.insert({"ada", 90});
+    scores.insert({"bob", 75});
+    scores.insert({"ada", 85});
+
+    std::cout << scores.count("ada") << std::endl;   // 2
+    auto range = scores.equal_range("ada");
+    for (auto it = range.first; it != range.second; ++it) {
+        std::cout << it->second << " ";               // 85 90
+    }
+    std::cout << std::endl << scores.erase("ada") << std::endl;   // 2
+    return 0;
+}
+
+Big O Notation for operations:
+
+- Insert / Emplace:
+  - Description: Finds the run of the new element's key, if any, and links the element in front of it.
+  - Average case: O(1)
+  - Worst case: O(n) (when all elements hash to the same bucket)
+
+- Find / Contains:
+  - Description: Finds the first element with the key.
+  - Average case: O(1)
+  - Worst case: O(n) (when all elements hash to the same bucket)
+
+- Equal range / Count / Erase (key):
+  - Description: Finds the run of elements with the key and walks it once.
+  - Average case: O(1 + k) (where k is the number of elements with the key)
+  - Worst case: O(n)
+
+- Range construction / Insert range:
+  - Description: Buckets sized once and elements counting-sorted by bucket, as for UnorderedMap. Every
+    element is kept.
+  - Average case: O(n + bucket_count) for n elements
+
+- Size / Empty / Bucket count / Load factor / Begin / End:
+  - Complexity: O(1)
+
+- Clear:
+  - Complexity: O(n)
+
+- Rehash / Reserve:
+  - Complexity: O(n + bucket_count)
+*/
+
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename Pred = std::equal_to<Key>,
+        typename RangeHash = prime_range_hash, typename Allocator = std::allocator<std::pair<const Key, T>>,
+        typename Stats = no_map_stats>
+class UnorderedMultiMap
+        : public _unordered_table<Key, std::pair<const Key, T>, false, Hash, Pred, RangeHash, Allocator, Stats> {
+    using _table = _unordered_table<Key, std::pair<const Key, T>, false, Hash, Pred, RangeHash, Allocator, Stats>;
+
+public:
+
+    using mapped_type = T;
+
+    using _table::_table;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <functional> // std::hash, std::equal_to
+#include <memory>     // std::allocator
+
+#include "UnorderedMap.h"
+
+/*
+UnorderedSet is UnorderedMap without the mapped values: its nodes hold the
+key alone, with no std::pair around it, and it runs on the same engine
+(_unordered_table), so it shares the node list, the allocator support, the
+range hashing, incremental rehashing, cached hash codes, transparent and
+batched lookups and the chain length watchdog, and gains whatever the map
+gains.
+
+Elements are keys, which must not change while they are in the set, so
+iterator and const_iterator are the same constant iterator. A node_type
+handle gives its key back through key() or value(), and there it may be
+changed.
+
+Example usage:
+
+#include "UnorderedSet.h"
+#include <iostream>
+
+int main() {
+    UnorderedSet<int> seen(16);
+
+    for (int x: {3, 1, 4, 1, 5, 9, 2, 6, 5, 3}) {
+        if (!seen.insert(x).second) {
+            std::cout << x << " ";   // 1 5 3
+        }
+    }
+    std::cout << std::endl << seen.size() << std::endl;   // 7
+    return 0;
+}
+
+Big O Notation for operations:
+
+- Insert / Emplace / Erase / Find / Contains / Count / Extract:
+  - Description: As for UnorderedMap, with the key as the whole element.
+  - Average case: O(1)
+  - Worst case: O(n) (when all elements hash to the same bucket)
+
+- Range construction / Insert range:
+  - Description: Buckets sized once and elements counting-sorted by bucket, as for UnorderedMap.
+  - Average case: O(n + bucket_count) for n elements
+
+- Size / Empty / Bucket count / Load factor / Begin / End:
+  - Complexity: O(1)
+
+- Clear:
+  - Complexity: O(n)
+
+- Rehash / Reserve:
+  - Complexity: O(n + bucket_count)
+*/
+
+template<typename Key, typename Hash = std::hash<Key>, typename Pred = std::equal_to<Key>,
+        typename RangeHash = prime_range_hash, typename Allocator = std::allocator<Key>, typename Stats = no_map_stats>
+class UnorderedSet : public _unordered_table<Key, Key, true, Hash, Pred, RangeHash, Allocator, Stats> {
+    using _table = _unordered_table<Key, Key, true, Hash, Pred, RangeHash, Allocator, Stats>;
+
+public:
+
+    using _table::_table;
+};
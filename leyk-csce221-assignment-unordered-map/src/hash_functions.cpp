@@ -20,12 +20,27 @@ int main() {
     size_t fnv_hash_value = fnv_hash(str);
     std::cout << "FNV-1a Hash of \"" << str << "\": " << fnv_hash_value << std::endl;
 
+    // Compute the wide block hash, which is the same on every path
+    wide_block_hash wide_hash;
+    size_t wide_hash_value = wide_hash(str);
+    std::cout << "Wide Block Hash of \"" << str << "\": " << wide_hash_value << std::endl;
+
+    // SipHash depends on its key: random unless one is given
+    sip_hash keyed_hash(1, 2);
+    std::cout << "SipHash-1-3 of \"" << str << "\": " << keyed_hash(str) << std::endl;
+
+    // string_views and C strings hash the same as the std::string
+    std::cout << (fnv_hash(std::string_view(str)) == fnv_hash_value) << (fnv_hash("example") == fnv_hash_value) << std::endl;
+
     return 0;
 }
 
 Expected output:
 Polynomial Rolling Hash of "example": <some_hash_value>
 FNV-1a Hash of "example": <some_hash_value>
+Wide Block Hash of "example": <some_hash_value>
+SipHash-1-3 of "example": <some_hash_value>
+11
 
 Big O Notation for hash functions:
 
@@ -36,11 +51,28 @@ Big O Notation for hash functions:
 - FNV-1a Hash:
   - Time complexity: O(n) (where n is the length of the string)
   - Space complexity: O(1)
+
+- Wide Block Hash:
+  - Time complexity: O(n), 32 bytes per step once the key is longer than 32 bytes
+  - Space complexity: O(1)
+
+- SipHash-1-3 (sip_hash):
+  - Time complexity: O(n), 8 bytes per round plus three finishing rounds
+  - Space complexity: O(1)
 */
 
 #include "hash_functions.h"
 
-size_t polynomial_rolling_hash::operator()(std::string const &str) const {
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+size_t polynomial_rolling_hash::operator()(std::string_view str) const {
     size_t hash = 0;
     size_t p = 1;
     for (char c: str) {
@@ -50,7 +82,7 @@ size_t polynomial_rolling_hash::operator()(std::string const &str) const {
     return hash;
 }
 
-std::size_t fnv1a_hash::operator()(std::string const &str) const {
+std::size_t fnv1a_hash::operator()(std::string_view str) const {
     const std::size_t prime = 0x00000100000001B3;
     std::size_t hash = 0xCBF29CE484222325;
 
@@ -62,25 +94,360 @@ std::size_t fnv1a_hash::operator()(std::string const &str) const {
     return hash;
 }
 
-size_t polynomial_rolling_hash::operator()(std::string const &str) const {
-    size_t hash = 0;
-    size_t p = 1;
-    for (char c: str) {
-        hash += c * p;
-        p = (p * 19) % 3298534883309ul;
+namespace {
+
+__extension__ typedef unsigned __int128 uint128;
+
+constexpr uint64_t PRIME32 = 0x9E3779B1;
+constexpr uint64_t PRIME64 = 0x9E3779B185EBCA87;
+
+constexpr size_t STRIPE_SIZE = 32;
+constexpr size_t STRIPES_PER_BLOCK = 8;
+
+// Stripe s of a block uses keys [s, s + 4), the scrambles keys [11, 15), the short keys and the merge [15, 21)
+constexpr size_t SCRAMBLE_KEY = STRIPES_PER_BLOCK + 3;
+constexpr size_t LAST_STRIPE_KEY = 5;
+constexpr size_t MIX_KEY = SCRAMBLE_KEY + 4;
+constexpr size_t N_KEYS = MIX_KEY + 6;
+
+struct key_table {
+    uint64_t keys[N_KEYS];
+
+    // Fills the table from splitmix64, so the keys have no structure
+    constexpr key_table() : keys{} {
+        uint64_t state = 0;
+        for (uint64_t &key: keys) {
+            state += 0x9E3779B97F4A7C15;
+            uint64_t z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            key = z ^ (z >> 31);
+        }
     }
-    return hash;
+};
+
+constexpr key_table SECRET;
+
+uint64_t load64(const char *p) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
 }
 
+uint32_t load32(const char *p) {
+    uint32_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
 
-std::size_t fnv1a_hash::operator()(std::string const &str) const {
-    const std::size_t prime = 0x00000100000001B3;
-    std::size_t hash = 0xCBF29CE484222325;
+// Folds the 128-bit product of a and b into 64 bits
+uint64_t fold(uint64_t a, uint64_t b) {
+    uint128 product = uint128{a} * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
 
-    for (char c: str) {
-        hash ^= c;
-        hash *= prime;
+uint64_t avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t hash_short(const char *p, size_t len) {
+    const uint64_t *key = SECRET.keys + MIX_KEY;
+    if (len > 16) {
+        uint64_t h = len * PRIME64;
+        h += fold(load64(p) ^ key[0], load64(p + 8) ^ key[1]);
+        h += fold(load64(p + len - 16) ^ key[2], load64(p + len - 8) ^ key[3]);
+        return avalanche(h);
+    }
+    if (len > 8) {
+        return avalanche(len + fold(load64(p) ^ key[0], load64(p + len - 8) ^ key[1]));
+    }
+    if (len >= 4) {
+        uint64_t word = load32(p) + (uint64_t{load32(p + len - 4)} << 32);
+        return avalanche(fold(word ^ key[0], key[1] + len));
+    }
+    if (len > 0) {
+        uint64_t first = static_cast<unsigned char>(p[0]);
+        uint64_t middle = static_cast<unsigned char>(p[len / 2]);
+        uint64_t last = static_cast<unsigned char>(p[len - 1]);
+        uint64_t word = (first << 16) | (middle << 24) | last | (len << 8);
+        return avalanche(fold(word ^ key[0], key[1]));
+    }
+    return avalanche(key[0] ^ key[1]);
+}
+
+/*
+    The long-key loop. Each stripe adds to lane i the product of the low
+    and high halves of (word i ^ key i), plus word i ^ 1 unmixed so no input
+    bit is lost when a product is zero. Keys move along the table from one
+    stripe to the next, and the lanes are scrambled after every block, so
+    where a stripe sits changes what it adds. The last stripe is read from
+    the end of the key and may overlap the one before it.
+*/
+using long_loop = void (*)(uint64_t *acc, const char *p, size_t len);
+
+void scalar_stripe(uint64_t *acc, const char *p, const uint64_t *key) {
+    for (size_t lane = 0; lane < 4; lane++) {
+        uint64_t word = load64(p + 8 * lane);
+        uint64_t keyed = word ^ key[lane];
+        acc[lane ^ 1] += word;
+        acc[lane] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
     }
+}
 
-    return hash;
-}
\ No newline at end of file
+void scalar_loop(uint64_t *acc, const char *p, size_t len) {
+    size_t n_stripes = (len - 1) / STRIPE_SIZE;
+    for (size_t stripe = 0; stripe < n_stripes; stripe++) {
+        size_t in_block = stripe % STRIPES_PER_BLOCK;
+        scalar_stripe(acc, p + stripe * STRIPE_SIZE, SECRET.keys + in_block);
+        if (in_block == STRIPES_PER_BLOCK - 1) {
+            for (size_t lane = 0; lane < 4; lane++) {
+                uint64_t scrambled = acc[lane] ^ (acc[lane] >> 47) ^ SECRET.keys[SCRAMBLE_KEY + lane];
+                acc[lane] = scrambled * PRIME32;
+            }
+        }
+    }
+    scalar_stripe(acc, p + len - STRIPE_SIZE, SECRET.keys + LAST_STRIPE_KEY);
+}
+
+#if defined(__SSE2__)
+
+// The same stripe on two lanes, (word, key) pairs of 16 bytes. The swap gives each lane its neighbour's word.
+__m128i sse2_stripe(__m128i acc, const char *p, const uint64_t *key) {
+    __m128i word = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i keyed = _mm_xor_si128(word, _mm_loadu_si128(reinterpret_cast<const __m128i *>(key)));
+    __m128i product = _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32));
+    __m128i swapped = _mm_shuffle_epi32(word, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm_add_epi64(acc, _mm_add_epi64(product, swapped));
+}
+
+__m128i sse2_scramble(__m128i acc, const uint64_t *key) {
+    const __m128i prime = _mm_set1_epi32(static_cast<int>(PRIME32));
+    acc = _mm_xor_si128(acc, _mm_srli_epi64(acc, 47));
+    acc = _mm_xor_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i *>(key)));
+    __m128i low = _mm_mul_epu32(acc, prime);
+    __m128i high = _mm_mul_epu32(_mm_srli_epi64(acc, 32), prime);
+    return _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+}
+
+void sse2_loop(uint64_t *acc, const char *p, size_t len) {
+    __m128i lanes[2];
+    for (size_t half = 0; half < 2; half++) {
+        lanes[half] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc + 2 * half));
+    }
+
+    size_t n_stripes = (len - 1) / STRIPE_SIZE;
+    for (size_t stripe = 0; stripe < n_stripes; stripe++) {
+        size_t in_block = stripe % STRIPES_PER_BLOCK;
+        for (size_t half = 0; half < 2; half++) {
+            lanes[half] = sse2_stripe(lanes[half], p + stripe * STRIPE_SIZE + 16 * half,
+                                      SECRET.keys + in_block + 2 * half);
+        }
+        if (in_block == STRIPES_PER_BLOCK - 1) {
+            for (size_t half = 0; half < 2; half++) {
+                lanes[half] = sse2_scramble(lanes[half], SECRET.keys + SCRAMBLE_KEY + 2 * half);
+            }
+        }
+    }
+    for (size_t half = 0; half < 2; half++) {
+        lanes[half] = sse2_stripe(lanes[half], p + len - STRIPE_SIZE + 16 * half,
+                                  SECRET.keys + LAST_STRIPE_KEY + 2 * half);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(acc + 2 * half), lanes[half]);
+    }
+}
+
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX2 is compiled in for these functions only, and run only when the CPU reports it
+__attribute__((target("avx2"))) inline __m256i avx2_stripe(__m256i acc, const char *p, const uint64_t *key) {
+    __m256i word = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i keyed = _mm256_xor_si256(word, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(key)));
+    __m256i product = _mm256_mul_epu32(keyed, _mm256_srli_epi64(keyed, 32));
+    __m256i swapped = _mm256_shuffle_epi32(word, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm256_add_epi64(acc, _mm256_add_epi64(product, swapped));
+}
+
+__attribute__((target("avx2"))) void avx2_loop(uint64_t *acc, const char *p, size_t len) {
+    const __m256i prime = _mm256_set1_epi32(static_cast<int>(PRIME32));
+    const __m256i scramble_key = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(SECRET.keys + SCRAMBLE_KEY));
+    __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc));
+
+    size_t n_stripes = (len - 1) / STRIPE_SIZE;
+    for (size_t stripe = 0; stripe < n_stripes; stripe++) {
+        size_t in_block = stripe % STRIPES_PER_BLOCK;
+        lanes = avx2_stripe(lanes, p + stripe * STRIPE_SIZE, SECRET.keys + in_block);
+        if (in_block == STRIPES_PER_BLOCK - 1) {
+            lanes = _mm256_xor_si256(lanes, _mm256_srli_epi64(lanes, 47));
+            lanes = _mm256_xor_si256(lanes, scramble_key);
+            __m256i low = _mm256_mul_epu32(lanes, prime);
+            __m256i high = _mm256_mul_epu32(_mm256_srli_epi64(lanes, 32), prime);
+            lanes = _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+        }
+    }
+    lanes = avx2_stripe(lanes, p + len - STRIPE_SIZE, SECRET.keys + LAST_STRIPE_KEY);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc), lanes);
+}
+
+#endif
+
+long_loop loop_for(wide_block_hash::isa path) {
+    switch (path) {
+#if defined(__x86_64__) || defined(__i386__)
+        case wide_block_hash::isa::avx2:
+            return avx2_loop;
+#endif
+#if defined(__SSE2__)
+        case wide_block_hash::isa::sse2:
+            return sse2_loop;
+#endif
+        default:
+            return scalar_loop;
+    }
+}
+
+uint64_t hash_long(const char *p, size_t len, long_loop loop) {
+    uint64_t acc[4] = {PRIME32, PRIME64, ~PRIME64, ~PRIME32};
+    loop(acc, p, len);
+
+    const uint64_t *key = SECRET.keys + MIX_KEY + 2;
+    uint64_t h = len * PRIME64;
+    h += fold(acc[0] ^ key[0], acc[1] ^ key[1]);
+    h += fold(acc[2] ^ key[2], acc[3] ^ key[3]);
+    return avalanche(h);
+}
+
+}
+
+bool wide_block_hash::supported(isa path) {
+    switch (path) {
+        case isa::scalar:
+            return true;
+        case isa::sse2:
+#if defined(__SSE2__)
+            return true;
+#else
+            return false;
+#endif
+        case isa::avx2:
+#if defined(__x86_64__) || defined(__i386__)
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+wide_block_hash::isa wide_block_hash::best() {
+    static const isa path = supported(isa::avx2) ? isa::avx2 : supported(isa::sse2) ? isa::sse2 : isa::scalar;
+    return path;
+}
+
+std::size_t wide_block_hash::hash(std::string_view str, isa path) {
+    if (str.size() <= STRIPE_SIZE) {
+        return hash_short(str.data(), str.size());
+    }
+    return hash_long(str.data(), str.size(), loop_for(path));
+}
+
+std::size_t wide_block_hash::operator()(std::string_view str) const {
+    if (str.size() <= STRIPE_SIZE) {
+        return hash_short(str.data(), str.size());
+    }
+    static const long_loop loop = loop_for(best());
+    return hash_long(str.data(), str.size(), loop);
+}
+
+namespace {
+
+uint64_t rotl(uint64_t x, int b) {
+    return (x << b) | (x >> (64 - b));
+}
+
+struct sip_state {
+    uint64_t v0, v1, v2, v3;
+
+    void round() {
+        v0 += v1;
+        v1 = rotl(v1, 13);
+        v1 ^= v0;
+        v0 = rotl(v0, 32);
+        v2 += v3;
+        v3 = rotl(v3, 16);
+        v3 ^= v2;
+        v0 += v3;
+        v3 = rotl(v3, 21);
+        v3 ^= v0;
+        v2 += v1;
+        v1 = rotl(v1, 17);
+        v1 ^= v2;
+        v2 = rotl(v2, 32);
+    }
+
+    void compress(uint64_t word) {
+        v3 ^= word;
+        round();
+        v0 ^= word;
+    }
+};
+
+uint64_t splitmix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+}
+
+/*
+    Keys come from a splitmix64 sequence whose start is drawn from
+    std::random_device once per process. The counter is atomic so maps can
+    be built on several threads at once.
+*/
+uint64_t next_key_word() {
+    static const uint64_t base = [] {
+        std::random_device device;
+        return (uint64_t{device()} << 32) ^ device();
+    }();
+    static std::atomic<uint64_t> counter{0};
+    return splitmix64(base + 0x9E3779B97F4A7C15 * counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+}
+
+sip_hash::sip_hash() {
+    reseed();
+}
+
+sip_hash::sip_hash(std::uint64_t k0, std::uint64_t k1) : _k0{k0}, _k1{k1} {}
+
+void sip_hash::reseed() {
+    _k0 = next_key_word();
+    _k1 = next_key_word();
+}
+
+std::size_t sip_hash::operator()(std::string_view str) const {
+    sip_state state{_k0 ^ 0x736F6D6570736575, _k1 ^ 0x646F72616E646F6D,
+                    _k0 ^ 0x6C7967656E657261, _k1 ^ 0x7465646279746573};
+
+    const char *p = str.data();
+    size_t len = str.size();
+    for (; len >= 8; len -= 8, p += 8) {
+        state.compress(load64(p));
+    }
+
+    // The last 0 to 7 bytes, little endian, with the length in the top byte
+    uint64_t last = uint64_t{str.size()} << 56;
+    for (size_t i = 0; i < len; i++) {
+        last |= uint64_t{static_cast<unsigned char>(p[i])} << (8 * i);
+    }
+    state.compress(last);
+
+    state.v2 ^= 0xFF;
+    for (int i = 0; i < 3; i++) {
+        state.round();
+    }
+    return state.v0 ^ state.v1 ^ state.v2 ^ state.v3;
+}
@@ -1,13 +1,83 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <cstddef>
+#include <cstdint>
 
+/*
+    Both hashers take a std::string_view, so std::string, string_view and
+    C strings all hash the same without building a std::string. They are
+    marked transparent: an UnorderedMap<std::string, T, fnv1a_hash,
+    std::equal_to<>> can be searched with any of them.
+*/
 struct polynomial_rolling_hash {
-    std::size_t operator()(std::string const &str) const;
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view str) const;
 };
 
 struct fnv1a_hash {
-    std::size_t operator()(std::string const &str) const;
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view str) const;
+};
+
+/*
+    A string hash for long keys. fnv1a_hash and polynomial_rolling_hash feed
+    one character at a time through a chain of multiplies, so they can never
+    go faster than the multiplier's latency. wide_block_hash reads keys of up
+    to 32 bytes as a few overlapping 8-byte words, and longer keys 32 bytes
+    per step into four independent accumulators, in the style of XXH3.
+
+    The long-key loop has a scalar, an SSE2 and an AVX2 version, which all
+    give the same hash. The best one the CPU supports is chosen the first
+    time a long key is hashed; hash(str, path) runs a specific one.
+*/
+struct wide_block_hash {
+    using is_transparent = void;
+
+    enum class isa {
+        scalar,
+        sse2,
+        avx2
+    };
+
+    std::size_t operator()(std::string_view str) const;
+
+    // Whether this build and this CPU can run path
+    static bool supported(isa path);
+
+    // The fastest supported path, which operator() uses
+    static isa best();
+
+    // Hashes str with the given path, which must be supported
+    static std::size_t hash(std::string_view str, isa path);
 };
 
+/*
+    SipHash-1-3, a hash keyed with a 128-bit secret. Without the key nobody
+    can tell which strings collide, so keys sent by untrusted clients cannot
+    be chosen to pile into one bucket, as they can for the unkeyed hashers
+    above. Each default-constructed sip_hash draws its own random key, so
+    every map gets a different one. reseed() draws a new key; UnorderedMap
+    calls it when max_chain_length is set and a bucket grows too long.
+*/
+struct sip_hash {
+    using is_transparent = void;
+
+    // A random key, different for every sip_hash constructed
+    sip_hash();
+
+    // A fixed key, for hashes which must be reproducible
+    sip_hash(std::uint64_t k0, std::uint64_t k1);
+
+    std::size_t operator()(std::string_view str) const;
+
+    // Replaces the key with a new random one
+    void reseed();
+
+private:
+    std::uint64_t _k0;
+    std::uint64_t _k1;
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>      // std::array
+#include <cstddef>    // size_t
+#include <stdexcept>  // std::invalid_argument
+#include <string>     // std::string
+
+#include "hash_functions.h"
+
+/*
+The string hashers main.cpp and benchmarks/hash_analysis.cpp compare. zero_hash
+and first_character_hash are deliberately bad: they show what a map turns
+into when every key, or every key with the same first letter, shares a
+bucket. with_hash picks one of them from a HashType, such as one read from a
+menu or a configuration file, without a branch on every hash.
+
+Example usage:
+
+#include "UnorderedMap.h"
+#include "hash_selector.h"
+
+int main() {
+    for (HashType htype: HASH_TYPES) {
+        size_t bucket = with_hash(htype, [](auto hash) {
+            UnorderedMap<std::string, int, decltype(hash)> map(30, hash);
+            map.insert({"Colorful Little Penguin", 0});
+            return map.bucket("Colorful Little Penguin");
+        });
+        std::cout << hash_type_name(htype) << ": " << bucket << std::endl;
+    }
+    return 0;
+}
+*/
+
+struct zero_hash {
+    size_t operator() (std::string const & str) const {
+        return 0;
+    }
+};
+
+struct first_character_hash  {
+    size_t operator() (std::string const & str) const {
+        if(str.length() == 0)
+            return 0ull;
+
+        return str[0];
+    }
+};
+
+enum class HashType {
+    ZERO,
+    FIRST_CHARACTER,
+    POLYNOMIAL_ROLLING,
+    FNV1A,
+    WIDE_BLOCK
+};
+
+constexpr std::array<HashType, 5> HASH_TYPES = {
+    HashType::ZERO,
+    HashType::FIRST_CHARACTER,
+    HashType::POLYNOMIAL_ROLLING,
+    HashType::FNV1A,
+    HashType::WIDE_BLOCK
+};
+
+inline char const * hash_type_name(HashType htype) {
+    switch(htype) {
+        case HashType::ZERO:
+            return "Zero Hash";
+        case HashType::FIRST_CHARACTER:
+            return "First Character Hash";
+        case HashType::POLYNOMIAL_ROLLING:
+            return "Polynomial Rolling Hash";
+        case HashType::FNV1A:
+            return "FNV-1A";
+        case HashType::WIDE_BLOCK:
+            return "Wide Block Hash";
+    }
+
+    return "";
+}
+
+/*
+    Calls fn with the hasher htype names and returns what it returns. The
+    switch runs once, here; fn is instantiated once per hasher, so every
+    map or loop it builds calls its hasher directly and can inline it.
+    fn must return the same type for every hasher. Throws
+    std::invalid_argument if htype is none of the HashType values.
+*/
+template<typename F>
+decltype(auto) with_hash(HashType htype, F && fn) {
+    switch(htype) {
+        case HashType::ZERO:
+            return fn(zero_hash{});
+        case HashType::FIRST_CHARACTER:
+            return fn(first_character_hash{});
+        case HashType::POLYNOMIAL_ROLLING:
+            return fn(polynomial_rolling_hash{});
+        case HashType::FNV1A:
+            return fn(fnv1a_hash{});
+        case HashType::WIDE_BLOCK:
+            return fn(wide_block_hash{});
+    }
+
+    throw std::invalid_argument("unknown HashType");
+}
@@ -1,5 +1,5 @@
 #include "UnorderedMap.h"
-#include "hash_functions.h"
+#include "hash_selector.h"
 
 #include <random>
 #include <limits>
@@ -20,88 +20,13 @@ static void print_sep() {
     std::cout << std::endl << std::endl;
 }
 
-struct zero_hash {
-    size_t operator() (std::string const & str) const {
-        return 0;
-    }
-};
-
-struct first_character_hash  {
-    size_t operator() (std::string const & str) const {
-        if(str.length() == 0)
-            return 0ull;
-
-        return str[0];
-    }
-};
-
-enum class HashType {
-    ZERO,
-    FIRST_CHARACTER,
-    POLYNOMIAL_ROLLING,
-    FNV1A
-};
-
-struct hash_selector {
-    zero_hash _zero_hash;
-    first_character_hash _first_char_hash;
-    polynomial_rolling_hash _poly_rolling_hash;
-    fnv1a_hash _fnv1a_hash;
-    HashType _htype;
-
-    public:
-
-    hash_selector(HashType htype) 
-        : _htype(htype)
-    {}
-
-    size_t operator() (std::string const & str) const {
-        switch(_htype) {
-            case HashType::ZERO:
-                return _zero_hash(str);
-            case HashType::FIRST_CHARACTER:
-                return _first_char_hash(str);
-            case HashType::POLYNOMIAL_ROLLING:
-                return _poly_rolling_hash(str);
-            case HashType::FNV1A:
-                return _fnv1a_hash(str);
-        }
-
-        return 0;
-    }
-};
-
 HashType prompt_hash_type() {
     using std::cin, std::cout, std::endl, std::ios;
 
     cout << "Which hash would you like to use:" << endl;
 
-    struct HashChoice {
-        std::string label;
-        HashType type; 
-    };
-
-    std::array<HashChoice const, 4> choices = {
-        HashChoice {
-            .label = "Zero Hash",
-            .type = HashType::ZERO,
-        },
-        HashChoice {
-            .label = "First Character Hash",
-            .type = HashType::FIRST_CHARACTER,
-        },
-        HashChoice {
-            .label = "Polynomial Rolling Hash",
-            .type = HashType::POLYNOMIAL_ROLLING,
-        },
-        HashChoice {
-            .label = "FNV-1A",
-            .type = HashType::FNV1A,
-        }
-    };
-
-    for(size_t i = 0; i < choices.size(); i++)
-        cout << "(" << i << "). " << choices[i].label << endl;
+    for(size_t i = 0; i < HASH_TYPES.size(); i++)
+        cout << "(" << i << "). " << hash_type_name(HASH_TYPES[i]) << endl;
     
 
     cout << endl;
@@ -116,13 +41,13 @@ HashType prompt_hash_type() {
             continue;
         }
 
-        if(choice >= choices.size())
+        if(choice >= HASH_TYPES.size())
             continue;
         
         break;
     } while(true);
 
-    return choices[choice].type;
+    return HASH_TYPES[choice];
 }
 
 namespace fs = std::filesystem;
@@ -162,21 +87,9 @@ class AnimalDistribution {
 
 constexpr size_t N_SAMPLE_HASHES = 5;
 
-int main() {
-    fs::path data_files = fs::path("..") / "data_files";
-
-    fs::path animals = data_files / "animals.txt";
-    fs::path adjectives = data_files / "adjectives.txt";
-
-    HashType htype = prompt_hash_type();
-
-    std::random_device rd;
-    std::mt19937 generator(rd());
-
-    hash_selector hash (htype);
-
-    AnimalDistribution distribution(adjectives, animals);
-
+// Fills a map hashed by hash with random animals and plots its buckets
+template<typename Hash>
+void report(Hash hash, AnimalDistribution const & distribution, std::mt19937 & generator) {
     std::cout << std::endl;
     std::cout << "Example hashes:" << std::endl;
     for(size_t i = 0; i < N_SAMPLE_HASHES; i++) {
@@ -184,7 +97,7 @@ int main() {
         std::cout << animal << ": " << hash(animal) << std::endl;
     }
 
-    UnorderedMap<std::string, int, hash_selector> map(30, hash);
+    UnorderedMap<std::string, int, Hash> map(30, hash);
 
     for(size_t i = 0; i < N_ELEMENTS; i++) {
         map.insert({distribution(generator), 0});
@@ -229,6 +142,24 @@ int main() {
     std::cout << "  Buckets: " << map.bucket_count() << std::endl;
     std::cout << "  Load factor: " << map.load_factor() << std::endl;
     std::cout << "  Load variance: " << load_variance << std::endl;
+}
+
+int main() {
+    fs::path data_files = fs::path("..") / "data_files";
+
+    fs::path animals = data_files / "animals.txt";
+    fs::path adjectives = data_files / "adjectives.txt";
+
+    HashType htype = prompt_hash_type();
+
+    std::random_device rd;
+    std::mt19937 generator(rd());
+
+    AnimalDistribution distribution(adjectives, animals);
+
+    with_hash(htype, [&](auto hash) {
+        report(hash, distribution, generator);
+    });
 
     return 0;
 }
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>   // std::array
+#include <cstddef> // size_t
+
+/*
+Statistics policies for UnorderedMap, UnorderedSet and UnorderedMultiMap.
+The policy is the last template parameter, after the allocator, and decides
+at compile time whether the map counts what it does:
+
+    no_map_stats        - the default. Counts nothing: it has no members, the
+                          map holds it as an empty base, and every call to it
+                          is an empty inline function, so neither the map's
+                          size nor a single instruction of a lookup changes.
+    counting_map_stats  - counts inserts, erases, lookups that hit and miss,
+                          how many keys each lookup compared (as a histogram
+                          and a maximum), rehashes and hash reseeds.
+
+A map with counting_map_stats has stats(), which returns a map_stats
+snapshot of the counters together with the longest chain in the map right
+now, and reset_stats(). A map made by copy or move, constructed or
+assigned, starts with zeroed counters. Lookups are counted from const
+member functions, so the counters are mutable, and, like the rest of the
+map, they must not be used from several threads at once.
+
+Every key search counts as a lookup: find, contains, count and equal_range,
+and also the search insert, emplace and erase make before they change the
+map, so an insert of a new key counts as a miss. The probes of a lookup are
+the keys it compared before it found its key or reached the end of the
+bucket; a lookup in an empty bucket has 0. With a good hash function the
+probe lengths of misses follow the load factor, and a histogram with a
+long tail, or a longest chain far above the load factor, points at a hash
+function that piles keys into a few buckets.
+
+Example usage:
+
+#include "UnorderedMap.h"
+#include <iostream>
+
+int main() {
+    UnorderedMap<int, int, std::hash<int>, std::equal_to<int>, prime_range_hash,
+                 std::allocator<std::pair<const int, int>>, counting_map_stats> map(100);
+
+    for (int i = 0; i < 1000; i++) {
+        map.insert({i * 103, i});   // Every key lands in bucket 0 of 103
+    }
+    map.find(5);
+
+    map_stats stats = map.stats();
+    std::cout << stats.hits << " " << stats.misses << " " << stats.max_chain << std::endl;   // 0 1001 1000
+    std::cout << stats.mean_probe_length() << std::endl;                                     // 499.001
+    return 0;
+}
+
+Big O Notation for operations:
+
+- Counting (every insert, erase, lookup and rehash):
+  - Complexity: O(1), a few increments; nothing at all with no_map_stats
+
+- stats():
+  - Description: Copies the counters and walks the node list once for the longest chain.
+  - Complexity: O(n)
+
+- reset_stats():
+  - Complexity: O(1)
+*/
+
+struct map_stats {
+    // Lookups comparing this many keys or more share the last entry of probe_lengths
+    static constexpr size_t PROBE_LENGTHS = 16;
+
+    size_t inserts = 0;
+    size_t erases = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+
+    // probe_lengths[k] lookups compared k keys
+    std::array<size_t, PROBE_LENGTHS> probe_lengths{};
+    size_t longest_probe = 0;
+    size_t total_probes = 0;
+
+    // Bucket arrays replaced, by growth, rehash, reserve or a reseed, and hash reseeds by the chain watchdog
+    size_t rehashes = 0;
+    size_t reseeds = 0;
+
+    // The longest chain in the map when the snapshot was taken
+    size_t max_chain = 0;
+
+    size_t lookups() const {
+        return hits + misses;
+    }
+
+    double mean_probe_length() const {
+        return lookups() == 0 ? 0.0 : static_cast<double>(total_probes) / lookups();
+    }
+};
+
+struct no_map_stats {
+    static constexpr bool enabled = false;
+
+    void on_lookup(size_t, bool) const {}
+
+    void on_insert() {}
+
+    void on_erase() {}
+
+    void on_rehash() {}
+
+    void on_reseed() {}
+};
+
+struct counting_map_stats {
+    static constexpr bool enabled = true;
+
+    void on_lookup(size_t probes, bool hit) const {
+        if (hit) {
+            _counts.hits++;
+        } else {
+            _counts.misses++;
+        }
+        _counts.probe_lengths[probes < map_stats::PROBE_LENGTHS ? probes : map_stats::PROBE_LENGTHS - 1]++;
+        _counts.total_probes += probes;
+        if (probes > _counts.longest_probe) {
+            _counts.longest_probe = probes;
+        }
+    }
+
+    void on_insert() {
+        _counts.inserts++;
+    }
+
+    void on_erase() {
+        _counts.erases++;
+    }
+
+    void on_rehash() {
+        _counts.rehashes++;
+    }
+
+    void on_reseed() {
+        _counts.reseeds++;
+    }
+
+    map_stats snapshot() const {
+        return _counts;
+    }
+
+    void reset() {
+        _counts = map_stats{};
+    }
+
+private:
+    mutable map_stats _counts;
+};
@@ -0,0 +1,70 @@
+#include "node_pool.h"
+
+#include <new> // operator new, operator delete
+
+node_pool::~node_pool() {
+    while (_chunks != nullptr) {
+        Chunk *chunk = _chunks;
+        _chunks = chunk->next;
+        ::operator delete(chunk);
+    }
+}
+
+void node_pool::_add_chunk(SizeClass &sizeClass, size_t blockSize) {
+    auto *chunk = static_cast<Chunk *>(::operator new(sizeof(Chunk) + sizeClass.chunk_blocks * blockSize));
+    chunk->next = _chunks;
+    _chunks = chunk;
+    _n_chunks++;
+
+    sizeClass.cursor = reinterpret_cast<char *>(chunk + 1);
+    sizeClass.end = sizeClass.cursor + sizeClass.chunk_blocks * blockSize;
+    if (sizeClass.chunk_blocks < _MAX_CHUNK_BLOCKS) {
+        sizeClass.chunk_blocks *= 2;
+    }
+}
+
+void *node_pool::allocate(size_t size) {
+    size_t index = _size_class(size);
+    size_t blockSize = (index + 1) * BLOCK_ALIGN;
+    SizeClass &sizeClass = _classes[index];
+    _n_live++;
+
+    if (sizeClass.free_list != nullptr) {
+        FreeBlock *block = sizeClass.free_list;
+        sizeClass.free_list = block->next;
+        return block;
+    }
+
+    if (sizeClass.cursor == sizeClass.end) {
+        _add_chunk(sizeClass, blockSize);
+    }
+    void *block = sizeClass.cursor;
+    sizeClass.cursor += blockSize;
+    return block;
+}
+
+void node_pool::deallocate(void *block, size_t size) noexcept {
+    SizeClass &sizeClass = _classes[_size_class(size)];
+    auto *freeBlock = static_cast<FreeBlock *>(block);
+    freeBlock->next = sizeClass.free_list;
+    sizeClass.free_list = freeBlock;
+    _n_live--;
+}
+
+bool node_pool::release() noexcept {
+    if (_n_live != 0) {
+        return false;
+    }
+
+    while (_chunks != nullptr) {
+        Chunk *chunk = _chunks;
+        _chunks = chunk->next;
+        ::operator delete(chunk);
+    }
+    _n_chunks = 0;
+
+    for (SizeClass &sizeClass : _classes) {
+        sizeClass = SizeClass{};
+    }
+    return true;
+}
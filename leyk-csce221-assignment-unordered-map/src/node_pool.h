@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>     // size_t, std::max_align_t
+#include <memory>      // std::allocator, std::shared_ptr
+#include <type_traits> // std::true_type, std::false_type
+
+/*
+node_pool is a slab allocator for small fixed size blocks, such as the
+HashNodes of an UnorderedMap. Blocks are carved out of chunks which hold
+32 blocks at first and twice as many each time a size class runs out, up
+to 4096. Freed blocks go on a per size free list and are handed out again
+before any new chunk is allocated, so a map which erases and inserts at a
+steady size stops allocating altogether.
+
+Every block size up to 256 bytes (rounded up to 16) has its own size class.
+Larger or over-aligned blocks are not pooled; pool_allocator forwards them
+to operator new.
+
+Example usage:
+
+#include "UnorderedMap.h"
+#include "node_pool.h"
+
+using Map = UnorderedMap<std::string, int, std::hash<std::string>, std::equal_to<std::string>,
+                         prime_range_hash, pool_allocator<std::pair<const std::string, int>>>;
+
+int main() {
+    Map map(100);
+    for (int i = 0; i < 1000; i++) {
+        map.insert({std::to_string(i), i});   // about 1000 / 4096 + log(1000 / 32) chunk allocations
+    }
+    map.clear();                              // nodes go back to the pool, which frees its chunks
+    return 0;
+}
+
+Big O Notation for operations:
+
+- allocate / deallocate:
+  - Description: Pops or pushes a block on the free list of its size class. allocate falls back to the
+    unused tail of the newest chunk, and allocates a new chunk when that is used up.
+  - Complexity: O(1), amortized over the blocks of a chunk
+
+- release:
+  - Description: Frees every chunk when no block is in use.
+  - Complexity: O(chunks)
+*/
+
+class node_pool {
+public:
+    // Alignment of every block, as guaranteed by operator new
+    static constexpr size_t BLOCK_ALIGN = alignof(std::max_align_t);
+    static constexpr size_t MAX_BLOCK_SIZE = 256;
+
+    node_pool() = default;
+
+    node_pool(const node_pool &) = delete;
+
+    node_pool &operator=(const node_pool &) = delete;
+
+    ~node_pool();
+
+    static bool pooled(size_t size, size_t alignment) noexcept {
+        return size <= MAX_BLOCK_SIZE && alignment <= BLOCK_ALIGN;
+    }
+
+    void *allocate(size_t size);
+
+    void deallocate(void *block, size_t size) noexcept;
+
+    /*
+        Frees every chunk if no block is in use and returns whether it did.
+        The pool stays usable afterwards and allocates new chunks on demand.
+    */
+    bool release() noexcept;
+
+    size_t n_chunks() const noexcept { return _n_chunks; }
+
+    size_t n_live() const noexcept { return _n_live; }
+
+private:
+    static constexpr size_t _N_SIZE_CLASSES = MAX_BLOCK_SIZE / BLOCK_ALIGN;
+    static constexpr size_t _FIRST_CHUNK_BLOCKS = 32;
+    static constexpr size_t _MAX_CHUNK_BLOCKS = 4096;
+
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    // Header at the start of each chunk, padded to BLOCK_ALIGN so the blocks after it stay aligned
+    struct alignas(BLOCK_ALIGN) Chunk {
+        Chunk *next;
+    };
+
+    struct SizeClass {
+        FreeBlock *free_list = nullptr;
+        char *cursor = nullptr; // Next block of the newest chunk which was never handed out
+        char *end = nullptr;
+        size_t chunk_blocks = _FIRST_CHUNK_BLOCKS;
+    };
+
+    static size_t _size_class(size_t size) noexcept {
+        return size == 0 ? 0 : (size - 1) / BLOCK_ALIGN;
+    }
+
+    void _add_chunk(SizeClass &sizeClass, size_t blockSize);
+
+    SizeClass _classes[_N_SIZE_CLASSES];
+    Chunk *_chunks = nullptr;
+    size_t _n_chunks = 0;
+    size_t _n_live = 0;
+};
+
+/*
+    A standard allocator which serves single objects from a shared node_pool
+    and forwards arrays and large objects to std::allocator. Copies and
+    rebound copies share one pool, so an UnorderedMap's nodes all come from
+    the pool of the allocator it was given. Copying a map gives the copy a
+    pool of its own, and move assignment takes the source's pool with its
+    nodes.
+*/
+template<typename T>
+class pool_allocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    pool_allocator() : _pool{std::make_shared<node_pool>()} {}
+
+    template<typename U>
+    pool_allocator(const pool_allocator<U> &other) noexcept : _pool{other._pool} {}
+
+    T *allocate(size_t n) {
+        if (n == 1 && node_pool::pooled(sizeof(T), alignof(T))) {
+            return static_cast<T *>(_pool->allocate(sizeof(T)));
+        }
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T *block, size_t n) noexcept {
+        if (n == 1 && node_pool::pooled(sizeof(T), alignof(T))) {
+            _pool->deallocate(block, sizeof(T));
+        } else {
+            std::allocator<T>{}.deallocate(block, n);
+        }
+    }
+
+    pool_allocator select_on_container_copy_construction() const {
+        return pool_allocator();
+    }
+
+    // Frees the pool's chunks if none of its blocks are in use. UnorderedMap::clear() calls this.
+    bool release() noexcept {
+        return _pool->release();
+    }
+
+    node_pool &pool() const noexcept {
+        return *_pool;
+    }
+
+    template<typename U>
+    bool operator==(const pool_allocator<U> &other) const noexcept {
+        return _pool == other._pool;
+    }
+
+    template<typename U>
+    bool operator!=(const pool_allocator<U> &other) const noexcept {
+        return _pool != other._pool;
+    }
+
+private:
+    template<typename U>
+    friend class pool_allocator;
+
+    std::shared_ptr<node_pool> _pool;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint64_t
+
+#include "primes.h"
+
+/*
+Range hashing policies for UnorderedMap. A policy maps a hash code onto a
+bucket index in [0, bucket_count). UnorderedMap keeps one policy object per
+bucket array and builds a new one whenever the bucket count changes, so a
+policy may precompute whatever it needs from the bucket count.
+
+Every policy provides:
+
+    static size_t bucket_count(size_t count);  // Bucket count used when at least count are requested
+    explicit Policy(size_t bucket_count);       // bucket_count is always a value returned by bucket_count()
+    size_t operator()(size_t hash_code) const;  // Bucket index of hash_code
+
+Example usage:
+
+#include "UnorderedMap.h"
+
+UnorderedMap<int, int> primes(100);                                          // hash % 101
+UnorderedMap<int, int, std::hash<int>, std::equal_to<int>, fastmod_range_hash> fast(100);  // hash % 101
+UnorderedMap<int, int, std::hash<int>, std::equal_to<int>, pow2_range_hash> pow2(100);     // mix(hash) & 127
+
+Big O Notation for operations:
+
+- prime_range_hash:
+  - Description: A prime bucket count and hash_code % bucket_count. This is the default and what the
+    assignment's tests expect. The division is a 64-bit divide by a runtime value on every call.
+  - Complexity: O(1), one 64-bit division
+
+- fastmod_range_hash:
+  - Description: The same prime bucket counts and the same bucket indices as prime_range_hash, computed with
+    Lemire's fastmod: a 128-bit reciprocal of the bucket count is precomputed when the buckets change,
+    and each reduction is then three multiplications.
+  - Complexity: O(1), no division
+
+- pow2_range_hash:
+  - Description: A power of two bucket count and a mask. Masking keeps only the low bits of the hash code,
+    which are poor for hashes such as std::hash<int> (the identity), so the code is first run through the
+    MurmurHash3 64-bit finalizer to spread every input bit over the low bits.
+  - Complexity: O(1), two multiplications
+
+benchmarks/range_hash.cpp measures the lookup throughput of each policy.
+*/
+
+/*
+    MurmurHash3's 64-bit finalizer: every output bit depends on every bit of
+    code. Shared by the maps which take bits of a hash code that identity
+    hashes such as std::hash<int> leave poor: pow2_range_hash's low bits,
+    ConcurrentUnorderedMap's shard bits, FlatUnorderedMap's slot and tag,
+    and StaticUnorderedMap's seeded codes.
+*/
+constexpr uint64_t _mix_hash_code(uint64_t code) {
+    code ^= code >> 33;
+    code *= 0xFF51AFD7ED558CCDull;
+    code ^= code >> 33;
+    code *= 0xC4CEB9FE1A85EC53ull;
+    code ^= code >> 33;
+    return code;
+}
+
+struct prime_range_hash {
+    size_t _bucket_count;
+
+    static size_t bucket_count(size_t count) {
+        return next_greater_prime(count);
+    }
+
+    explicit prime_range_hash(size_t bucket_count = 1) : _bucket_count{bucket_count} {}
+
+    size_t operator()(size_t hash_code) const {
+        return hash_code % _bucket_count;
+    }
+};
+
+struct fastmod_range_hash {
+    __extension__ typedef unsigned __int128 uint128;
+
+    uint128 _reciprocal;
+    uint64_t _bucket_count;
+
+    static size_t bucket_count(size_t count) {
+        return next_greater_prime(count);
+    }
+
+    // _reciprocal = ceil(2^128 / bucket_count), so that the fraction part of hash_code / bucket_count is exact
+    explicit fastmod_range_hash(size_t bucket_count = 1)
+            : _reciprocal{~uint128{0} / bucket_count + 1}, _bucket_count{bucket_count} {}
+
+    size_t operator()(size_t hash_code) const {
+        uint128 fraction = _reciprocal * hash_code;
+        uint128 low = (fraction & ~uint64_t{0}) * _bucket_count;
+        uint128 high = (fraction >> 64) * _bucket_count;
+        return static_cast<size_t>((high + (low >> 64)) >> 64);
+    }
+};
+
+struct pow2_range_hash {
+    size_t _mask;
+
+    static size_t bucket_count(size_t count) {
+        size_t power = 1;
+        while (power < count) {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    explicit pow2_range_hash(size_t bucket_count = 1) : _mask{bucket_count - 1} {}
+
+    size_t operator()(size_t hash_code) const {
+        return static_cast<size_t>(_mix_hash_code(hash_code)) & _mask;
+    }
+};
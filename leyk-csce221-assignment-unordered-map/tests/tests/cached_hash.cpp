@@ -0,0 +1,90 @@
+#include "executable.h"
+
+#include <unordered_map>
+
+/* Counts how often the map hashes a key */
+struct counting_hash {
+    size_t * calls;
+
+    counting_hash(size_t * calls = nullptr) : calls(calls) {}
+
+    size_t operator()(std::string const & str) const {
+        (*calls)++;
+        return std::hash<std::string>{}(str);
+    }
+};
+
+TEST(cached_hash) {
+    Typegen t;
+
+    static_assert(cache_hash_code<std::string, std::hash<std::string>>::value);
+    static_assert(!cache_hash_code<int, std::hash<int>>::value);
+
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = UnorderedMap<std::string, int, counting_hash>;
+
+        size_t calls = 0;
+        Map map(t.range(100ull), counting_hash(&calls));
+        std::unordered_map<std::string, int> gt_map;
+
+        size_t n_pairs = t.range(1000ull);
+        for(size_t j = 0; j < n_pairs; j++) {
+            std::string key = t.get<std::string>();
+            int value = t.get<int>();
+            gt_map.insert({key, value});
+
+            calls = 0;
+            map.insert({key, value});
+            ASSERT_EQ(1ULL, calls);
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+
+        // Iterating never hashes
+        calls = 0;
+        size_t count = 0;
+        for(auto it = map.begin(); it != map.end(); it++) {
+            ASSERT_EQ(gt_map.at(it->first), it->second);
+            count++;
+        }
+        ASSERT_EQ(map.size(), count);
+        ASSERT_EQ(0ULL, calls);
+
+        // Neither does growing, all at once or incrementally
+        map.rehash(t.range<size_t>(1, 2000));
+        ASSERT_EQ(0ULL, calls);
+
+        map.max_load_factor(0.5f);
+        map.rehash_step(1);
+        map.max_load_factor(0.25f);
+        for(size_t bucket = 0; bucket < map.bucket_count(); bucket++)
+            map.bucket_size(bucket);
+        ASSERT_EQ(0ULL, calls);
+
+        // Lookups hash once
+        for(auto const & [key, value] : gt_map) {
+            calls = 0;
+            ASSERT_EQ(value, map.find(key)->second);
+            ASSERT_EQ(1ULL, calls);
+        }
+
+        // Erasing through an iterator does not hash
+        calls = 0;
+        for(auto it = map.begin(); it != map.end();) {
+            if(it->second % 2)
+                it = map.erase(it);
+            else
+                it++;
+        }
+        ASSERT_EQ(0ULL, calls);
+
+        for(auto it = gt_map.begin(); it != gt_map.end();) {
+            if(it->second % 2)
+                it = gt_map.erase(it);
+            else
+                it++;
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+        for(auto const & [key, value] : gt_map)
+            ASSERT_EQ(value, map.find(key)->second);
+    }
+}
@@ -0,0 +1,106 @@
+#include "executable.h"
+#include "ConcurrentUnorderedMap.h"
+
+#include <thread>
+#include <unordered_map>
+
+TEST(concurrent_map) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = ConcurrentUnorderedMap<int, int>;
+        using value_type = std::pair<int, int>;
+
+        size_t n_shards = t.range<size_t>(1, 64);
+        Map map(t.range(1000ull), n_shards);
+        ASSERT_GE(map.shard_count(), n_shards);
+        ASSERT_LT(map.shard_count(), 2 * n_shards);
+
+        // On one thread it behaves like any map
+        size_t n_pairs = t.range(2000ul);
+        std::vector<value_type> pairs(n_pairs);
+        t.fill(pairs.begin(), pairs.end());
+
+        std::unordered_map<int, int> gt_map;
+        for(auto const & pair : pairs)
+            ASSERT_EQ(gt_map.insert(pair).second, map.insert(pair));
+        ASSERT_EQ(gt_map.size(), map.size());
+
+        for(auto const & [key, value] : gt_map) {
+            ASSERT_EQ(value, *map.find(key));
+            ASSERT_TRUE(map.contains(key));
+            ASSERT_TRUE(map.update(key, [](int & v) { v++; }));
+            int seen = 0;
+            ASSERT_TRUE(map.visit(key, [&](int const & v) { seen = v; }));
+            ASSERT_EQ(value + 1, seen);
+        }
+
+        size_t count = 0;
+        map.for_each([&](int const & key, int const & value) {
+            if(gt_map.at(key) + 1 == value)
+                count++;
+        });
+        ASSERT_EQ(gt_map.size(), count);
+
+        for(size_t j = 0; j < 100; j++) {
+            int key = t.get<int>();
+            ASSERT_EQ(gt_map.erase(key), map.erase(key));
+            ASSERT_FALSE(map.find(key).has_value());
+            ASSERT_FALSE(map.update(key, [](int & v) { v++; }));
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+
+        map.clear();
+        ASSERT_TRUE(map.empty());
+
+        // Consecutive keys with an identity hash still reach every shard
+        if(map.shard_count() <= 16) {
+            std::vector<size_t> shard_sizes(map.shard_count());
+            for(int key = 0; key < 1000; key++)
+                shard_sizes[map.shard(key)]++;
+            for(size_t shard_size : shard_sizes)
+                ASSERT_GT(shard_size, 0ULL);
+        }
+    }
+
+    // Many threads insert, update, read and erase at once
+    for(size_t i = 0; i < 4; i++) {
+        using Map = ConcurrentUnorderedMap<int, int>;
+
+        constexpr int N_THREADS = 8;
+        constexpr int N_KEYS = 2000;
+        constexpr int N_COUNTERS = 16;
+
+        Map map(0, t.range<size_t>(1, 32));
+        map.rehash_step(t.range<size_t>(0, 3));
+
+        std::vector<std::thread> threads;
+        for(int thread = 0; thread < N_THREADS; thread++) {
+            threads.emplace_back([&map, thread] {
+                // Counters every thread bumps, and keys only this thread owns
+                for(int key = 0; key < N_KEYS; key++) {
+                    int counter = -1 - key % N_COUNTERS;
+                    map.try_emplace(counter, 0);
+                    map.update(counter, [](int & v) { v++; });
+
+                    int own = thread * N_KEYS + key;
+                    map.insert({own, own});
+                    map.find(own + 1);
+                }
+                for(int key = 0; key < N_KEYS; key += 2)
+                    map.erase(thread * N_KEYS + key);
+            });
+        }
+        for(auto & thread : threads)
+            thread.join();
+
+        ASSERT_EQ(static_cast<size_t>(N_COUNTERS + N_THREADS * N_KEYS / 2), map.size());
+        for(int counter = 1; counter <= N_COUNTERS; counter++)
+            ASSERT_EQ(N_THREADS * N_KEYS / N_COUNTERS, *map.find(-counter));
+        for(int key = 0; key < N_THREADS * N_KEYS; key++) {
+            if(key % 2)
+                ASSERT_EQ(key, *map.find(key));
+            else
+                ASSERT_FALSE(map.contains(key));
+        }
+    }
+}
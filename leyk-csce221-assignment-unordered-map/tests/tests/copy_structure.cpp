@@ -0,0 +1,174 @@
+#include "executable.h"
+#include "UnorderedMultiMap.h"
+
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+TEST(copy_structure) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = UnorderedMap<std::string, int>;
+
+        size_t n_pairs = t.range(1000ul);
+        std::vector<std::pair<std::string, int>> pairs(n_pairs);
+        for(auto & pair : pairs)
+            pair = {t.get<std::string>(t.range(20ull)), t.get<int>()};
+
+        // Grows with incremental rehashing, so the copy is often taken mid-migration
+        size_t n = t.range<size_t>(1, 16);
+        Map src(n);
+        src.max_load_factor(1.0f);
+        src.rehash_step(t.range(3ull));
+        std::unordered_map<std::string, int> gt_map;
+        for(auto const & pair : pairs) {
+            src.insert(pair);
+            gt_map.insert(pair);
+        }
+
+        Map copy(src);
+        ASSERT_EQ(src.size(), copy.size());
+        ASSERT_EQ(src.bucket_count(), copy.bucket_count());
+
+        // Same layout: the copy iterates in the source's order, bucket by bucket
+        auto it = copy.begin();
+        for(auto const & [key, value] : src) {
+            ASSERT_TRUE(key == it->first);
+            ASSERT_EQ(value, it->second);
+            ++it;
+        }
+        ASSERT_TRUE((it == copy.end()));
+        for(size_t b = 0; b < src.bucket_count(); b++)
+            ASSERT_EQ(src.bucket_size(b), copy.bucket_size(b));
+
+        // And it goes on working as a map of its own
+        for(size_t j = 0; j < n_pairs; j++) {
+            std::string key = t.get<std::string>(t.range(20ull));
+            copy.insert({key, 1});
+            if(j % 3 == 0)
+                copy.erase(pairs[j].first);
+        }
+        ASSERT_EQ(gt_map.size(), src.size());
+        for(auto const & [key, value] : gt_map)
+            ASSERT_EQ(value, src.find(key)->second);
+
+        // Keys are 20 characters at most, so the stale one is dropped
+        Map assigned(t.range<size_t>(1, 64));
+        assigned.insert({std::string(21, 'x'), 0});
+        assigned = src;
+        ASSERT_EQ(gt_map.size(), assigned.size());
+        for(auto const & [key, value] : gt_map)
+            ASSERT_EQ(value, assigned.find(key)->second);
+    }
+
+    // A copied multimap keeps the order of equal keys
+    {
+        UnorderedMultiMap<int, int> src(7);
+        for(int j = 0; j < 100; j++)
+            src.insert({j % 5, j});
+        UnorderedMultiMap<int, int> copy(src);
+        for(int key = 0; key < 5; key++) {
+            auto a = src.equal_range(key);
+            auto b = copy.equal_range(key);
+            for(; a.first != a.second; ++a.first, ++b.first)
+                ASSERT_EQ(a.first->second, b.first->second);
+            ASSERT_TRUE((b.first == b.second));
+        }
+    }
+}
+
+TEST(clear_sparse) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        // Far more buckets than elements, so clear resets only the buckets in use
+        size_t n = t.range<size_t>(1000, 5000);
+        UnorderedMap<double, double> map(n);
+        map.max_load_factor(1.0f);
+
+        for(size_t round = 0; round < 3; round++) {
+            size_t n_pairs = t.range(n / 16);
+            std::vector<std::pair<double, double>> pairs(n_pairs);
+            t.fill(pairs.begin(), pairs.end());
+
+            shadow_map<double, double> shad_map(n);
+            for(auto const & pair : pairs) {
+                map.insert(pair);
+                shad_map.insert(pair);
+            }
+            ASSERT_PAIRS_FOUND_IN_CORRECT_BUCKETS(shad_map, map);
+
+            {
+                Memhook mh;
+                map.clear();
+                ASSERT_EQ(shad_map.size(), mh.n_frees());
+            }
+            ASSERT_TRUE(map.empty());
+            ASSERT_TRUE((map.begin() == map.end()));
+            for(size_t b = 0; b < map.bucket_count(); b++)
+                ASSERT_EQ(0ULL, map.bucket_size(b));
+        }
+    }
+}
+
+// Shared by every failing_allocator<T>, whatever the map rebinds it to
+bool fail_array_allocations = false;
+
+// std::allocator which throws for any array longer than one element while fail_array_allocations is set
+template<typename T>
+struct failing_allocator {
+    using value_type = T;
+
+    failing_allocator() = default;
+
+    template<typename U>
+    failing_allocator(failing_allocator<U> const &) {}
+
+    T * allocate(size_t n) {
+        if(fail_array_allocations && n > 1)
+            throw std::bad_alloc();
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T * p, size_t n) {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    friend bool operator==(failing_allocator const &, failing_allocator const &) { return true; }
+    friend bool operator!=(failing_allocator const &, failing_allocator const &) { return false; }
+};
+
+TEST(copy_assign_bad_alloc) {
+    using Map = UnorderedMap<int, int, std::hash<int>, std::equal_to<int>, prime_range_hash,
+                             failing_allocator<std::pair<const int, int>>>;
+    Map src(1000), map(10);
+    for(int j = 0; j < 100; j++) {
+        src.insert({j, j});
+        map.insert({-j, j});
+    }
+    size_t bucket_count = map.bucket_count();
+
+    // The bucket array for the copy cannot be allocated: the map is left empty, with its own buckets
+    fail_array_allocations = true;
+    bool thrown = false;
+    try {
+        map = src;
+    } catch(std::bad_alloc const &) {
+        thrown = true;
+    }
+    fail_array_allocations = false;
+    ASSERT_TRUE(thrown);
+    ASSERT_TRUE(map.empty());
+    ASSERT_EQ(bucket_count, map.bucket_count());
+    ASSERT_TRUE((map.begin() == map.end()));
+
+    // And it goes on working, as a map and as the target of a copy
+    for(int j = 0; j < 100; j++)
+        map.insert({j, -j});
+    for(int j = 0; j < 100; j++)
+        ASSERT_EQ(-j, map.find(j)->second);
+    map.clear();
+    map = src;
+    ASSERT_EQ(src.size(), map.size());
+    ASSERT_EQ(src.bucket_count(), map.bucket_count());
+}
@@ -0,0 +1,159 @@
+#include "executable.h"
+
+#include <unordered_map>
+
+/* A value which counts how it was made */
+struct counted_value {
+    static size_t n_constructs;
+    static size_t n_copies;
+    static size_t n_moves;
+
+    int value;
+
+    counted_value(int value = 0) : value(value) { n_constructs++; }
+
+    counted_value(int a, int b) : value(a + b) { n_constructs++; }
+
+    counted_value(counted_value const & other) : value(other.value) { n_copies++; }
+
+    counted_value(counted_value && other) : value(other.value) { n_moves++; }
+
+    counted_value & operator=(counted_value const & other) = default;
+
+    counted_value & operator=(counted_value && other) = default;
+
+    static void reset() {
+        n_constructs = 0;
+        n_copies = 0;
+        n_moves = 0;
+    }
+};
+
+size_t counted_value::n_constructs = 0;
+size_t counted_value::n_copies = 0;
+size_t counted_value::n_moves = 0;
+
+TEST(emplace_and_extract) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = UnorderedMap<int, counted_value>;
+
+        size_t n_pairs = t.range(1000ull);
+        std::vector<std::pair<int, int>> pairs(n_pairs);
+        t.fill(pairs.begin(), pairs.end());
+
+        Map map(t.range(100ull));
+        std::unordered_map<int, int> gt_map;
+
+        // try_emplace builds the value in its node from the arguments
+        for(auto const & [key, value] : pairs) {
+            bool inserted = gt_map.insert({key, value}).second;
+
+            counted_value::reset();
+            Memhook mh;
+            auto [it, map_inserted] = map.try_emplace(key, value, 0);
+            ASSERT_EQ(inserted, map_inserted);
+            ASSERT_EQ(key, it->first);
+            ASSERT_EQ(gt_map[key], it->second.value);
+            // and does nothing at all on a hit
+            ASSERT_EQ(inserted ? 1ULL : 0ULL, mh.n_allocs());
+            ASSERT_EQ(inserted ? 1ULL : 0ULL, counted_value::n_constructs);
+            ASSERT_EQ(0ULL, counted_value::n_copies);
+            ASSERT_EQ(0ULL, counted_value::n_moves);
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+
+        // emplace constructs in place and frees its node on a duplicate
+        for(size_t j = 0; j < 100; j++) {
+            int key = t.get<int>();
+            int value = t.get<int>();
+            bool inserted = gt_map.insert({key, value}).second;
+
+            counted_value::reset();
+            Memhook mh;
+            auto result = map.emplace(std::piecewise_construct, std::forward_as_tuple(key),
+                                      std::forward_as_tuple(value));
+            ASSERT_EQ(inserted, result.second);
+            ASSERT_EQ(gt_map[key], result.first->second.value);
+            ASSERT_EQ(1ULL, mh.n_allocs());
+            ASSERT_EQ(inserted ? 0ULL : 1ULL, mh.n_frees());
+            ASSERT_EQ(1ULL, counted_value::n_constructs);
+            ASSERT_EQ(0ULL, counted_value::n_copies + counted_value::n_moves);
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+
+        // insert_or_assign inserts or overwrites
+        for(size_t j = 0; j < 100; j++) {
+            int key = t.range(2) || pairs.empty() ? t.get<int>() : pairs[t.range(n_pairs)].first;
+            int value = t.get<int>();
+            bool inserted = gt_map.count(key) == 0;
+            gt_map[key] = value;
+
+            auto result = map.insert_or_assign(key, counted_value(value));
+            ASSERT_EQ(inserted, result.second);
+            ASSERT_EQ(value, result.first->second.value);
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+
+        // operator[] value-initializes missing elements in place
+        {
+            int key = t.get<int>();
+            bool inserted = gt_map.count(key) == 0;
+            counted_value::reset();
+            int value = map[key].value;
+            ASSERT_EQ(inserted ? 0 : gt_map[key], value);
+            ASSERT_EQ(0ULL, counted_value::n_copies + counted_value::n_moves);
+            gt_map[key] = value;
+        }
+
+        // Nodes move between maps without allocating or touching the element
+        Map dst_map(t.range(100ull));
+        std::vector<int> keys;
+        for(auto const & [key, value] : gt_map)
+            keys.push_back(key);
+
+        for(int key : keys) {
+            counted_value::reset();
+            Memhook mh;
+            Map::node_type nh = t.range(2) ? map.extract(key) : map.extract(map.find(key));
+            ASSERT_FALSE(nh.empty());
+            ASSERT_EQ(key, nh.key());
+            ASSERT_EQ(gt_map[key], nh.mapped().value);
+
+            auto result = dst_map.insert(std::move(nh));
+            ASSERT_TRUE(result.inserted);
+            ASSERT_TRUE(result.node.empty());
+            ASSERT_TRUE(nh.empty());
+            ASSERT_EQ(key, result.position->first);
+            ASSERT_EQ(0ULL, mh.n_allocs());
+            ASSERT_EQ(0ULL, mh.n_frees());
+            ASSERT_EQ(0ULL, counted_value::n_constructs + counted_value::n_copies + counted_value::n_moves);
+        }
+        ASSERT_TRUE(map.empty());
+        ASSERT_EQ(gt_map.size(), dst_map.size());
+        for(auto const & [key, value] : gt_map)
+            ASSERT_EQ(value, dst_map.find(key)->second.value);
+
+        // Extracting a missing key gives an empty handle
+        ASSERT_TRUE(map.extract(t.get<int>()).empty());
+        ASSERT_FALSE(map.insert(Map::node_type()).inserted);
+
+        // A duplicate hands the node back, and the handle frees it
+        if(!keys.empty()) {
+            int key = keys[t.range(keys.size())];
+            map.try_emplace(key, 1);
+            Map::node_type nh = map.extract(key);
+            nh.mapped().value = 2;
+
+            auto result = dst_map.insert(std::move(nh));
+            ASSERT_FALSE(result.inserted);
+            ASSERT_FALSE(result.node.empty());
+            ASSERT_EQ(2, result.node.mapped().value);
+            ASSERT_EQ(gt_map[key], result.position->second.value);
+
+            Memhook mh;
+            result.node = Map::node_type();
+            ASSERT_EQ(1ULL, mh.n_frees());
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#include "executable.h"
+#include <unordered_map>
+
+TEST(erase_if) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+
+        size_t n_pairs = t.range(1000ul);
+
+        std::vector<std::pair<int, int>> pairs(n_pairs);
+        t.fill_unique(pairs.begin(), pairs.end());
+
+        size_t n = t.range(100ull);
+        UnorderedMap<int, int> map(n);
+        shadow_map<int, int>   gt_map(n);
+        map.rehash_step(t.range(3ull));
+
+        for(auto const & pair : pairs) {
+            map.insert(pair);
+            gt_map.insert(pair);
+        }
+
+        // Every element whose value is below the threshold goes
+        int threshold = t.get<int>();
+        size_t expected = 0;
+        for(auto const & [key, value] : pairs) {
+            if(value < threshold) {
+                gt_map.erase(key);
+                expected++;
+            }
+        }
+
+        size_t erased;
+        {
+            Memhook mh;
+            erased = map.erase_if([threshold](auto const & pair) { return pair.second < threshold; });
+            ASSERT_EQ(0ULL, mh.n_allocs());
+            ASSERT_EQ(expected, mh.n_frees());
+        }
+
+        ASSERT_EQ(expected, erased);
+        ASSERT_EQ(gt_map.size(), map.size());
+        ASSERT_PAIRS_FOUND_IN_CORRECT_BUCKETS(gt_map, map);
+
+        ASSERT_EQ(map.size(), map.erase_if([](auto const &) { return true; }));
+        ASSERT_TRUE(map.empty());
+        ASSERT_TRUE((map.begin() == map.end()));
+    }
+}
+
+TEST(erase_iterator_sweep) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+
+        size_t n_pairs = t.range(1000ul);
+
+        std::vector<std::pair<int, int>> pairs(n_pairs);
+        t.fill_unique(pairs.begin(), pairs.end());
+
+        size_t n = t.range(100ull);
+        UnorderedMap<int, int> map(n);
+        shadow_map<int, int>   gt_map(n);
+        map.rehash_step(t.range(3ull));
+
+        for(size_t j = 0; j < n_pairs / 2; j++) {
+            map.insert(pairs[j]);
+            gt_map.insert(pairs[j]);
+        }
+
+        // it = erase(it) sweeps, with inserts in between which leave the
+        // iterator's remembered node stale, so that erase falls back to
+        // walking the bucket
+        size_t next = n_pairs / 2;
+        auto it = map.begin();
+        while(it != map.end()) {
+            if(t.range(3ull) == 0) {
+                gt_map.erase(it->first);
+                it = map.erase(it);
+            } else {
+                ++it;
+            }
+
+            if(next < n_pairs && t.range(5ull) == 0) {
+                map.insert(pairs[next]);
+                gt_map.insert(pairs[next]);
+                next++;
+            }
+        }
+
+        ASSERT_EQ(gt_map.size(), map.size());
+        ASSERT_PAIRS_FOUND_IN_CORRECT_BUCKETS(gt_map, map);
+
+        // Iterators from find, some of them stale by the time they are erased
+        for(auto const & pair : pairs) {
+            auto found = map.find(pair.first);
+            if(found == map.end())
+                continue;
+            if(next < n_pairs && t.range(2ull) == 0) {
+                map.insert(pairs[next]);
+                gt_map.insert(pairs[next]);
+                next++;
+            }
+            gt_map.erase(pair.first);
+            map.erase(found);
+        }
+
+        ASSERT_EQ(gt_map.size(), map.size());
+        ASSERT_PAIRS_FOUND_IN_CORRECT_BUCKETS(gt_map, map);
+    }
+}
@@ -0,0 +1,86 @@
+#include "executable.h"
+
+#include <string_view>
+#include <unordered_map>
+
+TEST(find_batch) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = UnorderedMap<int, int>;
+        using value_type = std::pair<int, int>;
+
+        size_t n_pairs = t.range(2000ul);
+        std::vector<value_type> pairs(n_pairs);
+        t.fill(pairs.begin(), pairs.end());
+
+        // Grow incrementally so some batches run while old buckets are still pending
+        Map map(t.range(100ull));
+        std::unordered_map<int, int> gt_map;
+        map.max_load_factor(1.0f);
+        map.rehash_step(t.range<size_t>(0, 3));
+        for(auto const & pair : pairs) {
+            map.insert(pair);
+            gt_map.insert(pair);
+        }
+
+        // Present and missing keys, in a count which is no multiple of the batch size
+        std::vector<int> keys;
+        for(auto const & pair : pairs)
+            keys.push_back(pair.first);
+        size_t n_missing = t.range(100ull);
+        for(size_t j = 0; j < n_missing; j++)
+            keys.push_back(t.get<int>());
+        for(size_t j = 0; j + 1 < keys.size(); j++)
+            std::swap(keys[j], keys[j + t.range(keys.size() - j)]);
+
+        std::vector<Map::iterator> found(keys.size());
+        ASSERT_TRUE(map.find_batch(keys.begin(), keys.end(), found.begin()) == found.end());
+
+        Map const & cmap = map;
+        std::vector<Map::const_iterator> cfound;
+        cmap.find_batch(keys.begin(), keys.end(), std::back_inserter(cfound));
+        ASSERT_EQ(keys.size(), cfound.size());
+
+        std::vector<bool> contained;
+        map.contains_batch(keys.begin(), keys.end(), std::back_inserter(contained));
+        ASSERT_EQ(keys.size(), contained.size());
+
+        for(size_t j = 0; j < keys.size(); j++) {
+            auto gt_it = gt_map.find(keys[j]);
+            ASSERT_TRUE(found[j] == map.find(keys[j]));
+            ASSERT_EQ(gt_it != gt_map.end(), contained[j]);
+            if(gt_it != gt_map.end()) {
+                ASSERT_EQ(gt_it->second, found[j]->second);
+                ASSERT_EQ(gt_it->second, cfound[j]->second);
+            } else {
+                ASSERT_TRUE(found[j] == map.end());
+            }
+        }
+
+        // Transparent keys are looked up without building a Key
+        using StringMap = UnorderedMap<std::string, int, fnv1a_hash, std::equal_to<>>;
+        StringMap string_map(t.range(100ull));
+        std::vector<std::string> strings;
+        for(auto const & pair : pairs) {
+            strings.push_back(std::to_string(pair.first));
+            string_map.insert({strings.back(), pair.second});
+        }
+        strings.push_back("not a number");
+        std::vector<std::string_view> views(strings.begin(), strings.end());
+
+        std::vector<StringMap::iterator> string_found;
+        string_found.reserve(views.size());
+        {
+            Memhook mh;
+            string_map.find_batch(views.begin(), views.end(), std::back_inserter(string_found));
+            ASSERT_EQ(0ULL, mh.n_allocs());
+        }
+        for(size_t j = 0; j < views.size(); j++)
+            ASSERT_TRUE(string_found[j] == string_map.find(strings[j]));
+
+        // An empty range writes nothing
+        std::vector<bool> none;
+        map.contains_batch(keys.end(), keys.end(), std::back_inserter(none));
+        ASSERT_TRUE(none.empty());
+    }
+}
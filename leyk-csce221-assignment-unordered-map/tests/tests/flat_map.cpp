@@ -0,0 +1,190 @@
+#include "executable.h"
+#include "FlatUnorderedMap.h"
+
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+TEST(flat_map) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = FlatUnorderedMap<int, double>;
+        using iter = typename Map::iterator;
+
+        size_t n_pairs = t.range(1000ul);
+        std::vector<std::pair<int, double>> pairs(n_pairs);
+        t.fill(pairs.begin(), pairs.end());
+
+        // Keep the keys small so inserts, finds and erases collide
+        for(auto & pair : pairs)
+            pair.first %= 500;
+
+        size_t n = t.range(100ull);
+
+        Memhook mh;
+        {
+            Map map(n);
+            std::unordered_map<int, double> gt_map;
+
+            for(auto const & pair : pairs) {
+                auto [gt_it, gt_inserted] = gt_map.insert(pair);
+                auto [it, inserted] = map.insert(pair);
+
+                ASSERT_EQ(gt_inserted, inserted);
+                ASSERT_EQ(gt_it->first, it->first);
+                ASSERT_EQ(gt_it->second, it->second);
+                ASSERT_EQ(gt_map.size(), map.size());
+                ASSERT_LE(map.load_factor(), map.max_load_factor());
+            }
+
+            for(auto const & pair : pairs) {
+                if(t.get<bool>(0.5)) {
+                    ASSERT_EQ(gt_map.erase(pair.first), map.erase(pair.first));
+                } else {
+                    gt_map[pair.first] = pair.second;
+                    map[pair.first] = pair.second;
+                }
+                ASSERT_EQ(gt_map.size(), map.size());
+            }
+
+            for(int key = 0; key < 500; key++) {
+                auto found = gt_map.find(key);
+                iter it = map.find(key);
+
+                if(found == gt_map.end()) {
+                    ASSERT_TRUE(it == map.end());
+                } else {
+                    ASSERT_TRUE(it != map.end());
+                    ASSERT_EQ(found->second, it->second);
+                }
+            }
+
+            size_t count = 0;
+            for(iter it = map.begin(); it != map.end(); it++) {
+                ASSERT_TRUE(gt_map.find(it->first) != gt_map.end());
+                count++;
+            }
+            ASSERT_EQ(gt_map.size(), count);
+
+            Map cpy_map { map };
+            ASSERT_EQ(map.size(), cpy_map.size());
+
+            // Erase through iterators, checking each returns its successor
+            iter it = map.begin();
+            while(it != map.end()) {
+                iter after = it;
+                after++;
+
+                gt_map.erase(it->first);
+                it = map.erase(it);
+
+                ASSERT_TRUE(it == after);
+                ASSERT_EQ(gt_map.size(), map.size());
+            }
+            ASSERT_TRUE(map.empty());
+            ASSERT_TRUE(map.begin() == map.end());
+
+            for(iter it = cpy_map.begin(); it != cpy_map.end(); ++it) {
+                ASSERT_TRUE(map.insert(*it).second);
+            }
+
+            Map mv_map { std::move(cpy_map) };
+            ASSERT_EQ(map.size(), mv_map.size());
+            ASSERT_TRUE(cpy_map.empty());
+
+            mv_map.clear();
+            ASSERT_TRUE(mv_map.empty());
+            ASSERT_TRUE(mv_map.begin() == mv_map.end());
+        }
+
+        mh.disable();
+        ASSERT_EQ_(mh.n_allocs(), mh.n_frees(), "Destructor does not deallocate enough");
+    }
+}
+
+TEST(flat_map_sparse_iteration) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = FlatUnorderedMap<int, int>;
+
+        // Tables from a few slots, under one scanned group, to thousands
+        size_t n_keys = t.range(4000ul);
+        Map map(t.range(64ull));
+        std::unordered_map<int, int> gt_map;
+        for(size_t j = 0; j < n_keys; j++) {
+            int key = t.get<int>();
+            map.insert({key, key});
+            gt_map.insert({key, key});
+        }
+
+        // Erase nearly everything, leaving long runs of empty slots and tombstones
+        size_t keep = t.range(8ull);
+        for(auto gt_it = gt_map.begin(); gt_it != gt_map.end();) {
+            if(keep > 0 && t.get<bool>(0.01)) {
+                keep--;
+                ++gt_it;
+            } else {
+                ASSERT_EQ(1ul, map.erase(gt_it->first));
+                gt_it = gt_map.erase(gt_it);
+            }
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+
+        size_t count = 0;
+        for(auto it = map.begin(); it != map.end(); ++it) {
+            ASSERT_TRUE(gt_map.find(it->first) != gt_map.end());
+            count++;
+        }
+        ASSERT_EQ(gt_map.size(), count);
+
+        count = 0;
+        for(auto it = map.cbegin(); it != map.cend(); ++it)
+            count++;
+        ASSERT_EQ(gt_map.size(), count);
+
+        // Erasing through iterators returns the next full slot across the gaps
+        for(auto it = map.begin(); it != map.end();) {
+            ASSERT_EQ(1ul, gt_map.erase(it->first));
+            it = map.erase(it);
+        }
+        ASSERT_TRUE(gt_map.empty());
+        ASSERT_TRUE(map.begin() == map.end());
+    }
+}
+
+TEST(flat_map_sequential_keys) {
+    // std::hash<int> is the identity; without mixing, sequential keys share home slots and build one long probe run
+    constexpr int N_KEYS = 100000;
+    FlatUnorderedMap<int, int> map(0);
+    for(int key = 0; key < N_KEYS; key++)
+        ASSERT_TRUE(map.insert({key, -key}).second);
+    ASSERT_EQ(static_cast<size_t>(N_KEYS), map.size());
+
+    for(int key = 0; key < N_KEYS; key++) {
+        auto it = map.find(key);
+        ASSERT_TRUE(it != map.end());
+        ASSERT_EQ(-key, it->second);
+    }
+    ASSERT_TRUE(map.find(N_KEYS) == map.end());
+
+    // The home slots spread like random ones: well over half the keys get a slot of their own
+    std::vector<bool> home(map.bucket_count(), false);
+    size_t distinct = 0;
+    for(int key = 0; key < N_KEYS; key++) {
+        size_t slot = map.bucket(key);
+        distinct += !home[slot];
+        home[slot] = true;
+    }
+    ASSERT_GT(distinct, static_cast<size_t>(N_KEYS) / 2);
+}
+
+TEST(flat_map_max_load_factor_invalid) {
+    FlatUnorderedMap<int, int> map(16);
+    ASSERT_EXCEPTION(map.max_load_factor(0.0f), std::invalid_argument);
+    ASSERT_EXCEPTION(map.max_load_factor(-0.5f), std::invalid_argument);
+    ASSERT_EXCEPTION(map.max_load_factor(std::numeric_limits<float>::quiet_NaN()), std::invalid_argument);
+
+    // Values above 1 are still clamped
+    map.max_load_factor(4.0f);
+    ASSERT_EQ(1.0f, map.max_load_factor());
+}
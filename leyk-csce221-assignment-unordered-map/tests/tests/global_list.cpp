@@ -0,0 +1,85 @@
+#include "executable.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+/* Counts how often the map hashes a key */
+struct counting_int_hash {
+    size_t * calls;
+
+    counting_int_hash(size_t * calls = nullptr) : calls(calls) {}
+
+    size_t operator()(int key) const {
+        (*calls)++;
+        return std::hash<int>{}(key);
+    }
+};
+
+TEST(global_list) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = UnorderedMap<int, int, counting_int_hash>;
+        using value_type = std::pair<int, int>;
+
+        static_assert(!cache_hash_code<int, counting_int_hash>::value);
+
+        size_t n_pairs = t.range(2000ul);
+        std::vector<value_type> pairs(n_pairs);
+        t.fill(pairs.begin(), pairs.end());
+
+        size_t calls = 0;
+        Map map(t.range(10000ull), counting_int_hash(&calls));
+        std::unordered_map<int, int> gt_map;
+        for(auto const & pair : pairs) {
+            map.insert(pair);
+            gt_map.insert(pair);
+        }
+
+        // Erase most of the map so nearly every bucket is empty
+        for(auto const & pair : pairs) {
+            if(t.range(10) != 0) {
+                map.erase(pair.first);
+                gt_map.erase(pair.first);
+            }
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+
+        // Iterating walks the node list only: no hashing, every element once
+        {
+            calls = 0;
+            std::unordered_set<int> seen;
+            for(auto it = map.begin(); it != map.end(); ++it) {
+                ASSERT_EQ(gt_map.at(it->first), it->second);
+                ASSERT_TRUE(seen.insert(it->first).second);
+            }
+            ASSERT_EQ(0ULL, calls);
+            ASSERT_EQ(map.size(), seen.size());
+        }
+
+        // Each bucket is a contiguous run of the list
+        size_t count = 0;
+        for(size_t bucket = 0; bucket < map.bucket_count(); bucket++) {
+            size_t bucket_count = 0;
+            for(auto it = map.begin(bucket); it != map.end(bucket); it++) {
+                ASSERT_EQ(bucket, map.bucket(it->first));
+                bucket_count++;
+            }
+            ASSERT_EQ(bucket_count, map.bucket_size(bucket));
+            count += bucket_count;
+        }
+        ASSERT_EQ(map.size(), count);
+
+        // Erasing while iterating returns the next node of the list
+        for(auto it = map.begin(); it != map.end();) {
+            auto next = it;
+            ++next;
+            int key = it->first;
+            ASSERT_TRUE(next == map.erase(it));
+            ASSERT_EQ(1ULL, gt_map.erase(key));
+            it = next;
+        }
+        ASSERT_TRUE(map.empty());
+        ASSERT_TRUE(gt_map.empty());
+        ASSERT_TRUE(map.begin() == map.end());
+    }
+}
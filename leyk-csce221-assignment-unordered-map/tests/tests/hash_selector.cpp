@@ -0,0 +1,24 @@
+#include "executable.h"
+#include "hash_selector.h"
+
+#include <stdexcept>
+#include <string>
+
+TEST(hash_selector) {
+    std::string key = "Colorful Little Penguin";
+    for(HashType htype : HASH_TYPES) {
+        size_t expected = 0;
+        switch(htype) {
+            case HashType::ZERO: expected = zero_hash{}(key); break;
+            case HashType::FIRST_CHARACTER: expected = first_character_hash{}(key); break;
+            case HashType::POLYNOMIAL_ROLLING: expected = polynomial_rolling_hash{}(key); break;
+            case HashType::FNV1A: expected = fnv1a_hash{}(key); break;
+            case HashType::WIDE_BLOCK: expected = wide_block_hash{}(key); break;
+        }
+        ASSERT_EQ(expected, with_hash(htype, [&](auto hash) -> size_t { return hash(key); }));
+    }
+
+    // A value outside the enum is refused rather than mapped to some hasher
+    ASSERT_EXCEPTION(with_hash(static_cast<HashType>(99), [&](auto hash) -> size_t { return hash(key); }),
+                     std::invalid_argument);
+}
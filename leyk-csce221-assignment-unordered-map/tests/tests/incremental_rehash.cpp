@@ -0,0 +1,101 @@
+#include "executable.h"
+#include "map_logic.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+template<typename Map>
+bool iterates_each_once(Map & map) {
+    std::unordered_set<typename Map::key_type> seen;
+    for(auto it = map.begin(); it != map.end(); it++) {
+        if(!seen.insert(it->first).second)
+            return false;
+    }
+    return seen.size() == map.size();
+}
+
+TEST(incremental_rehash) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = UnorderedMap<int, int>;
+        using value_type = std::pair<int, int>;
+
+        size_t n_pairs = t.range(2000ul);
+        std::vector<value_type> pairs(n_pairs);
+        t.fill(pairs.begin(), pairs.end());
+
+        size_t n = t.range(100ull);
+        size_t step = t.range<size_t>(1, 4);
+
+        Map map(n);
+        std::unordered_map<int, int> gt_map;
+        map.max_load_factor(1.0f);
+        map.rehash_step(step);
+        ASSERT_EQ(step, map.rehash_step());
+
+        bool migrated = false;
+        for(auto const & pair : pairs) {
+            gt_map.insert(pair);
+            {
+                Memhook mh;
+                map.insert(pair);
+                // At most the node, a new bucket array and freeing the old one
+                ASSERT_LE(mh.n_allocs(), 2ULL);
+                ASSERT_LE(mh.n_frees(), 1ULL);
+            }
+            migrated |= map.rehashing();
+
+            ASSERT_EQ(gt_map.size(), map.size());
+            ASSERT_EQ(pair.first, map.find(pair.first)->first);
+        }
+        if(n_pairs > 2 * next_greater_prime(n))
+            ASSERT_TRUE(migrated);
+
+        // Lookups, erases and iteration see both bucket arrays mid-migration
+        ASSERT_TRUE(iterates_each_once(map));
+        for(auto const & [key, value] : gt_map)
+            ASSERT_EQ(value, map.find(key)->second);
+
+        size_t n_erase = t.range(gt_map.size());
+        for(size_t j = 0; j < n_erase; j++) {
+            int key = pairs[t.range(n_pairs - 1)].first;
+            ASSERT_EQ(gt_map.erase(key), map.erase(key));
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+        ASSERT_TRUE(iterates_each_once(map));
+
+        for(auto it = map.begin(); it != map.end();) {
+            if(it->first % 2)
+                it = map.erase(it);
+            else
+                it++;
+        }
+        for(auto it = gt_map.begin(); it != gt_map.end();) {
+            if(it->first % 2)
+                it = gt_map.erase(it);
+            else
+                it++;
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+        ASSERT_TRUE(iterates_each_once(map));
+
+        // Copies see every element regardless of where it lives
+        Map cpy_map { map };
+        ASSERT_EQ(map.size(), cpy_map.size());
+        for(auto const & [key, value] : gt_map)
+            ASSERT_EQ(value, cpy_map.find(key)->second);
+
+        // Bucket queries finish the migration and report the new layout
+        size_t count = 0;
+        for(size_t bucket = 0; bucket < map.bucket_count(); bucket++) {
+            for(auto it = map.begin(bucket); it != map.end(bucket); it++) {
+                ASSERT_EQ(bucket, map.bucket(it->first));
+                ASSERT_EQ(correct_bucket<Map>(it->first, map.bucket_count()), bucket);
+                count++;
+            }
+            ASSERT_FALSE(map.rehashing());
+        }
+        ASSERT_EQ(map.size(), count);
+        ASSERT_LE(map.load_factor(), 1.0f);
+    }
+}
@@ -0,0 +1,98 @@
+#include "executable.h"
+#include "map_logic.h"
+
+#include <list>
+#include <unordered_map>
+
+template<typename Map>
+bool matches(Map & map, std::unordered_map<typename Map::key_type, typename Map::mapped_type> const & gt_map) {
+    if(map.size() != gt_map.size())
+        return false;
+    for(auto const & [key, value] : gt_map) {
+        auto it = map.find(key);
+        if(it == map.end() || it->second != value)
+            return false;
+    }
+
+    size_t count = 0;
+    for(size_t bucket = 0; bucket < map.bucket_count(); bucket++) {
+        for(auto it = map.begin(bucket); it != map.end(bucket); it++) {
+            if(correct_bucket<Map>(it->first, map.bucket_count()) != bucket)
+                return false;
+            count++;
+        }
+    }
+    return count == map.size();
+}
+
+TEST(insert_range) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = UnorderedMap<int, int>;
+        using value_type = std::pair<int, int>;
+
+        // Few distinct keys, so the input has plenty of duplicates
+        size_t n_pairs = t.range(2000ul);
+        int n_keys = static_cast<int>(t.range<size_t>(1, 2000));
+        std::vector<value_type> pairs(n_pairs);
+        for(auto & pair : pairs)
+            pair = {t.range(n_keys), t.get<int>()};
+
+        // The first occurrence of a key wins, as with one insert after another
+        std::unordered_map<int, int> gt_map;
+        for(auto const & pair : pairs)
+            gt_map.insert(pair);
+
+        Map map(pairs.begin(), pairs.end());
+        ASSERT_TRUE(matches(map, gt_map));
+        ASSERT_GE(map.bucket_count(), n_pairs);
+        ASSERT_LE(map.load_factor(), 1.0f);
+
+        size_t n_buckets = t.range(5000ull);
+        Map sized_map(pairs.begin(), pairs.end(), n_buckets);
+        ASSERT_TRUE(matches(sized_map, gt_map));
+        ASSERT_GE(sized_map.bucket_count(), n_buckets);
+
+        std::list<value_type> pair_list(pairs.begin(), pairs.end());
+        Map list_map(pair_list.begin(), pair_list.end());
+        ASSERT_TRUE(matches(list_map, gt_map));
+
+        // Inserting a range into a map which already holds elements, grows and is mid-migration
+        std::vector<value_type> more_pairs(t.range(2000ul));
+        t.fill(more_pairs.begin(), more_pairs.end());
+
+        Map grown_map(t.range(100ull));
+        grown_map.max_load_factor(t.range(0.25f, 2.0f));
+        grown_map.rehash_step(t.range<size_t>(0, 3));
+        for(auto const & pair : more_pairs)
+            grown_map.insert(pair);
+        grown_map.insert(pairs.begin(), pairs.end());
+        ASSERT_LE(grown_map.load_factor(), grown_map.max_load_factor());
+
+        std::unordered_map<int, int> grown_gt_map(more_pairs.begin(), more_pairs.end());
+        grown_gt_map.insert(pairs.begin(), pairs.end());
+        ASSERT_TRUE(matches(grown_map, grown_gt_map));
+
+        // Ranges much smaller than the bucket count go one element at a time
+        Map sparse_map(20000);
+        size_t n_sparse = std::min<size_t>(pairs.size(), 100);
+        sparse_map.insert(pairs.begin(), pairs.begin() + n_sparse);
+        std::unordered_map<int, int> sparse_gt_map(pairs.begin(), pairs.begin() + n_sparse);
+        ASSERT_TRUE(matches(sparse_map, sparse_gt_map));
+
+        Map init_map { {1, 10}, {2, 20}, {1, 30} };
+        ASSERT_EQ(2ULL, init_map.size());
+        ASSERT_EQ(10, init_map.find(1)->second);
+        init_map.insert({ {3, 30}, {2, 40} });
+        ASSERT_EQ(3ULL, init_map.size());
+        ASSERT_EQ(20, init_map.find(2)->second);
+
+        // Every node is still freed one at a time
+        {
+            size_t size = map.size();
+            Memhook mh;
+            map.clear();
+            ASSERT_EQ(size, mh.n_frees());
+        }
+    }
+}
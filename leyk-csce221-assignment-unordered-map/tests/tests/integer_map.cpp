@@ -0,0 +1,146 @@
+#include "executable.h"
+#include "IntegerUnorderedMap.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+TEST(integer_map) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = IntegerUnorderedMap<int, double>;
+
+        size_t n_pairs = t.range(1000ul);
+        std::vector<std::pair<int, double>> pairs(n_pairs);
+        t.fill(pairs.begin(), pairs.end());
+
+        // Keep the keys small so inserts, finds and erases collide, and key 0 (the empty key) comes up
+        for(auto & pair : pairs)
+            pair.first %= 500;
+
+        size_t n = t.range(100ull);
+
+        Memhook mh;
+        {
+            Map map(n);
+            std::unordered_map<int, double> gt_map;
+
+            for(auto const & pair : pairs) {
+                auto [gt_it, gt_inserted] = gt_map.insert(pair);
+                auto [it, inserted] = map.insert(pair);
+
+                ASSERT_EQ(gt_inserted, inserted);
+                ASSERT_EQ(gt_it->first, it->first);
+                ASSERT_EQ(gt_it->second, it->second);
+                ASSERT_EQ(gt_map.size(), map.size());
+                ASSERT_LE(map.load_factor(), map.max_load_factor());
+            }
+
+            for(auto const & pair : pairs) {
+                if(t.get<bool>(0.5)) {
+                    ASSERT_EQ(gt_map.erase(pair.first), map.erase(pair.first));
+                } else {
+                    gt_map[pair.first] = pair.second;
+                    map[pair.first] = pair.second;
+                }
+                ASSERT_EQ(gt_map.size(), map.size());
+            }
+
+            for(int key = -10; key < 510; key++) {
+                auto found = gt_map.find(key);
+                auto it = map.find(key);
+
+                if(found == gt_map.end()) {
+                    ASSERT_TRUE(it == map.end());
+                    ASSERT_FALSE(map.contains(key));
+                    ASSERT_EXCEPTION(map.at(key), std::out_of_range);
+                } else {
+                    ASSERT_TRUE(it != map.end());
+                    ASSERT_EQ(found->second, it->second);
+                    ASSERT_EQ(found->second, map.at(key));
+                }
+            }
+
+            size_t count = 0;
+            for(auto [key, value] : map) {
+                ASSERT_EQ(gt_map.at(key), value);
+                count++;
+            }
+            ASSERT_EQ(gt_map.size(), count);
+
+            Map cpy_map { map };
+            ASSERT_EQ(map.size(), cpy_map.size());
+
+            // Erase every other element through iterators; erasing shifts later elements back
+            size_t visited = 0;
+            for(auto it = map.begin(); it != map.end(); visited++) {
+                if(visited % 2 == 0) {
+                    gt_map.erase(it->first);
+                    it = map.erase(it);
+                } else {
+                    ++it;
+                }
+                ASSERT_EQ(gt_map.size(), map.size());
+            }
+            ASSERT_EQ(cpy_map.size(), visited);
+            for(auto const & [key, value] : gt_map)
+                ASSERT_EQ(value, map.at(key));
+
+            map.clear();
+            ASSERT_TRUE(map.empty());
+            ASSERT_TRUE(map.begin() == map.end());
+
+            Map mv_map { std::move(cpy_map) };
+            ASSERT_TRUE(cpy_map.empty());
+            for(auto [key, value] : mv_map)
+                ASSERT_TRUE(map.insert({key, value}).second);
+            ASSERT_EQ(mv_map.size(), map.size());
+        }
+
+        mh.disable();
+        ASSERT_EQ_(mh.n_allocs(), mh.n_frees(), "Destructor does not deallocate enough");
+    }
+}
+
+TEST(integer_map_wide_keys) {
+    // 2^64 / golden ratio, and its inverse modulo 2^64
+    const uint64_t golden = 0x9E3779B97F4A7C15ull;
+    uint64_t inverse = golden;
+    for(int step = 0; step < 6; step++)
+        inverse *= 2 - golden * inverse;
+
+    IntegerUnorderedMap<uint64_t, std::string> map(4);
+    std::unordered_map<uint64_t, std::string> gt_map;
+
+    // These keys hash to the last home slot of any table below 2^14 slots, so their run spills
+    // into the overflow area, grows the table and must survive a rehash which overflows
+    for(uint64_t j = 0; j < 40; j++) {
+        uint64_t key = inverse * (~uint64_t{0} - j);
+        map[key] = std::to_string(j);
+        gt_map[key] = std::to_string(j);
+        map.insert({j, "small"});
+        gt_map.insert({j, "small"});
+    }
+    map.rehash(1);
+
+    ASSERT_EQ(gt_map.size(), map.size());
+    for(auto const & [key, value] : gt_map)
+        ASSERT_TRUE(map.at(key) == value);
+
+    for(uint64_t j = 0; j < 40; j += 2) {
+        uint64_t key = inverse * (~uint64_t{0} - j);
+        ASSERT_EQ(1ULL, map.erase(key));
+        gt_map.erase(key);
+    }
+    ASSERT_EQ(gt_map.size(), map.size());
+    for(auto const & [key, value] : gt_map)
+        ASSERT_TRUE(map.at(key) == value);
+
+    // Dense keys pack tightly
+    IntegerUnorderedMap<int, int> dense(0);
+    for(int key = 0; key < 100000; key++)
+        dense[key] = key;
+    ASSERT_LE(dense.bytes_per_entry(), 16.0);
+    dense.reserve(100000);
+    ASSERT_LE(dense.bytes_per_entry(), 10.0);
+}
@@ -1,5 +1,8 @@
 #include "executable.h"
 
+#include <limits>
+#include <stdexcept>
+
 TEST(load_factor) {
     Typegen t;
     for(size_t i = 0; i < TEST_ITER; i++) {
@@ -24,3 +27,25 @@ TEST(load_factor) {
         }
     }
 }
+
+TEST(max_load_factor_invalid) {
+    UnorderedMap<int, int> map(11);
+    for(int i = 0; i < 20; i++)
+        map.insert({i, i});
+
+    // A maximum which no load factor can stay under is refused and leaves the map as it was
+    ASSERT_EXCEPTION(map.max_load_factor(0.0f), std::invalid_argument);
+    ASSERT_EXCEPTION(map.max_load_factor(-1.0f), std::invalid_argument);
+    ASSERT_EXCEPTION(map.max_load_factor(std::numeric_limits<float>::quiet_NaN()), std::invalid_argument);
+    ASSERT_EQ(11ul, map.bucket_count());
+    ASSERT_EQ(20ul, map.size());
+
+    // Infinity is the default and keeps the bucket count fixed
+    map.max_load_factor(1.0f);
+    size_t grown = map.bucket_count();
+    ASSERT_GT(grown, 11ul);
+    map.max_load_factor(std::numeric_limits<float>::infinity());
+    for(int i = 20; i < 1000; i++)
+        map.insert({i, i});
+    ASSERT_EQ(grown, map.bucket_count());
+}
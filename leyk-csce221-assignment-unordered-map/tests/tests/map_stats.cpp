@@ -0,0 +1,172 @@
+#include "executable.h"
+#include "UnorderedMultiMap.h"
+#include "UnorderedSet.h"
+
+#include <type_traits>
+#include <unordered_map>
+
+template<typename Key, typename T>
+using CountingMap = UnorderedMap<Key, T, std::hash<Key>, std::equal_to<Key>, prime_range_hash,
+                                 std::allocator<std::pair<const Key, T>>, counting_map_stats>;
+
+// Sends every key to the same hash code, so each lookup walks the whole map
+struct constant_hash {
+    size_t operator()(int) const { return 7; }
+};
+
+TEST(map_stats) {
+    // The default policy adds nothing to the map
+    static_assert(std::is_empty<no_map_stats>::value);
+    static_assert(sizeof(UnorderedMap<int, int>) ==
+                  sizeof(UnorderedMap<int, int, std::hash<int>, std::equal_to<int>, prime_range_hash,
+                                      std::allocator<std::pair<const int, int>>, no_map_stats>));
+
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        CountingMap<int, int> map(t.range<size_t>(1, 64));
+        map.rehash_step(t.range(3ull));
+        std::unordered_map<int, int> gt_map;
+
+        size_t n_ops = t.range(2000ul);
+        size_t inserts = 0, erases = 0, hits = 0, misses = 0;
+        for(size_t j = 0; j < n_ops; j++) {
+            int key = t.range(256);
+            bool present = gt_map.count(key) > 0;
+            present ? hits++ : misses++;
+            switch(t.range(3)) {
+                case 0:
+                    map.insert({key, key});
+                    inserts += gt_map.insert({key, key}).second;
+                    break;
+                case 1:
+                    map.erase(key);
+                    erases += gt_map.erase(key);
+                    break;
+                default:
+                    ASSERT_EQ(present, map.find(key) != map.end());
+                    break;
+            }
+        }
+
+        map_stats stats = map.stats();
+        ASSERT_EQ(inserts, stats.inserts);
+        ASSERT_EQ(erases, stats.erases);
+        ASSERT_EQ(hits, stats.hits);
+        ASSERT_EQ(misses, stats.misses);
+        ASSERT_EQ(n_ops, stats.lookups());
+
+        size_t histogram = 0;
+        for(size_t count : stats.probe_lengths)
+            histogram += count;
+        ASSERT_EQ(stats.lookups(), histogram);
+        ASSERT_TRUE(stats.total_probes <= stats.lookups() * stats.longest_probe);
+
+        size_t longest = 0;
+        for(size_t b = 0; b < map.bucket_count(); b++)
+            longest = std::max(longest, map.bucket_size(b));
+        ASSERT_EQ(longest, map.stats().max_chain);
+
+        map.reset_stats();
+        stats = map.stats();
+        ASSERT_EQ(0ul, stats.lookups());
+        ASSERT_EQ(0ul, stats.inserts);
+        ASSERT_EQ(0ul, stats.total_probes);
+        ASSERT_EQ(longest, stats.max_chain);
+    }
+}
+
+TEST(map_stats_collisions) {
+    // The example of map_stats.h: 1000 keys in bucket 0 of 103
+    CountingMap<int, int> map(100);
+    for(int i = 0; i < 1000; i++)
+        map.insert({i * 103, i});
+    map.find(5);
+
+    map_stats stats = map.stats();
+    ASSERT_EQ(0ul, stats.hits);
+    ASSERT_EQ(1001ul, stats.misses);
+    ASSERT_EQ(1000ul, stats.max_chain);
+    ASSERT_EQ(999ul, stats.longest_probe);
+    ASSERT_EQ(size_t{999 * 1000 / 2}, stats.total_probes);
+    ASSERT_EQ(2ul, stats.probe_lengths[0]);
+    ASSERT_EQ(1ul, stats.probe_lengths[1]);
+    ASSERT_EQ(size_t{1000 - map_stats::PROBE_LENGTHS + 1}, stats.probe_lengths[map_stats::PROBE_LENGTHS - 1]);
+    ASSERT_EQ(0ul, stats.rehashes);
+
+    // A hash with one code: finding key k compares every key inserted before it
+    UnorderedSet<int, constant_hash, std::equal_to<int>, prime_range_hash, std::allocator<int>, counting_map_stats>
+            set(16);
+    set.max_load_factor(1.0f);
+    for(int i = 0; i < 100; i++)
+        set.insert(i);
+    set.reset_stats();
+    for(int i = 0; i < 100; i++)
+        ASSERT_TRUE(set.contains(i));
+    stats = set.stats();
+    ASSERT_EQ(100ul, stats.hits);
+    ASSERT_EQ(100ul, stats.max_chain);
+    ASSERT_EQ(100ul, stats.longest_probe);
+    ASSERT_EQ(size_t{100 * 101 / 2}, stats.total_probes);
+
+    // Growth and rehash() both replace the bucket array
+    CountingMap<int, int> growing(1);
+    growing.max_load_factor(1.0f);
+    size_t bucket_counts = 0;
+    for(int i = 0; i < 1000; i++) {
+        size_t before = growing.bucket_count();
+        growing.insert({i, i});
+        bucket_counts += growing.bucket_count() != before;
+    }
+    growing.rehash(5000);
+    ASSERT_EQ(bucket_counts + 1, growing.stats().rehashes);
+    ASSERT_EQ(0ul, growing.stats().reseeds);
+
+    // The multimap counts every element it inserts
+    UnorderedMultiMap<int, int, std::hash<int>, std::equal_to<int>, prime_range_hash,
+                      std::allocator<std::pair<const int, int>>, counting_map_stats> multi(16);
+    for(int i = 0; i < 300; i++)
+        multi.insert({i % 10, i});
+    ASSERT_EQ(300ul, multi.stats().inserts);
+    ASSERT_EQ(30ul, multi.erase(3));
+    ASSERT_EQ(30ul, multi.stats().erases);
+}
+
+TEST(map_stats_copy_and_move) {
+    CountingMap<int, int> a(16), b(16);
+    for(int i = 0; i < 100; i++) {
+        a.insert({i, i});
+        a.find(i);
+    }
+    for(int i = 0; i < 10; i++)
+        b.insert({i, i});
+
+    // Constructed or assigned, a copy or move starts counting from zero
+    CountingMap<int, int> copied(a);
+    ASSERT_EQ(0ul, copied.stats().inserts);
+    ASSERT_EQ(0ul, copied.stats().lookups());
+
+    a = b;
+    ASSERT_EQ(10ul, a.size());
+    ASSERT_EQ(0ul, a.stats().inserts);
+    ASSERT_EQ(0ul, a.stats().hits);
+    ASSERT_EQ(0ul, a.stats().lookups());
+    ASSERT_EQ(10ul, b.stats().inserts);
+
+    CountingMap<int, int> d(16);
+    for(int i = 0; i < 50; i++)
+        d.insert({i, i});
+    d = std::move(copied);
+    ASSERT_EQ(100ul, d.size());
+    ASSERT_EQ(0ul, d.stats().inserts);
+    ASSERT_EQ(0ul, d.stats().lookups());
+
+    CountingMap<int, int> moved(std::move(d));
+    ASSERT_EQ(0ul, moved.stats().inserts);
+
+    // And counts its own operations from there
+    a.insert({-1, 0});
+    a.find(-1);
+    ASSERT_EQ(1ul, a.stats().inserts);
+    ASSERT_EQ(1ul, a.stats().hits);
+    ASSERT_EQ(1ul, a.stats().misses);
+}
@@ -0,0 +1,115 @@
+#include "executable.h"
+#include "MappedUnorderedMap.h"
+
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+TEST(mapped_map) {
+    Typegen t;
+    std::string path = (std::filesystem::temp_directory_path() / "mapped_map_test.img").string();
+
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        UnorderedMap<std::string, int, fnv1a_hash> map(t.range(100ull));
+        std::unordered_map<std::string, int> gt_map;
+        size_t n_pairs = t.range(2000ull);
+        for(size_t j = 0; j < n_pairs; j++) {
+            std::string key = t.get<std::string>(t.range(20ull));
+            int value = t.get<int>();
+            map.insert({key, value});
+            gt_map.insert({key, value});
+        }
+
+        MappedUnorderedMap<int>::write(path, map);
+        MappedUnorderedMap<int> image(path);
+        ASSERT_EQ(gt_map.size(), image.size());
+        ASSERT_EQ(gt_map.empty(), image.empty());
+        ASSERT_LE(image.load_factor(), 1.0f);
+
+        // Every key is found with its value, from a std::string, a string_view or a C string
+        for(auto const & [key, value] : gt_map) {
+            auto it = image.find(key);
+            ASSERT_TRUE(it != image.end());
+            ASSERT_TRUE(it->first == key);
+            ASSERT_EQ(value, it->second);
+            ASSERT_EQ(value, image.at(std::string_view(key)));
+            ASSERT_EQ(1ULL, image.count(key.c_str()));
+        }
+
+        for(size_t j = 0; j < 100; j++) {
+            std::string key = t.get<std::string>(21);
+            ASSERT_FALSE(image.contains(key));
+            ASSERT_TRUE(image.find(key) == image.end());
+        }
+
+        // Iteration visits every element once, bucket by bucket
+        size_t count = 0;
+        size_t bucket = 0;
+        for(auto const & [key, value] : image) {
+            ASSERT_EQ(gt_map.at(std::string(key)), value);
+            ASSERT_LE(bucket, image.bucket(key));
+            bucket = image.bucket(key);
+            count++;
+        }
+        ASSERT_EQ(gt_map.size(), count);
+
+        size_t bucket_total = 0;
+        for(size_t b = 0; b < image.bucket_count(); b++)
+            bucket_total += image.bucket_size(b);
+        ASSERT_EQ(gt_map.size(), bucket_total);
+
+        // A moved image still points into the same mapping
+        MappedUnorderedMap<int> moved(std::move(image));
+        for(auto const & [key, value] : gt_map)
+            ASSERT_EQ(value, moved.at(key));
+    }
+
+    // Images written differently are refused
+    {
+        UnorderedMap<std::string, int, fnv1a_hash> map(10);
+        map.insert({"key", 1});
+        MappedUnorderedMap<int>::write(path, map);
+
+        ASSERT_EXCEPTION(MappedUnorderedMap<long long>{path}, std::runtime_error);
+        ASSERT_EXCEPTION((MappedUnorderedMap<int, wide_block_hash>{path}), std::runtime_error);
+        ASSERT_EXCEPTION((MappedUnorderedMap<int, fnv1a_hash, pow2_range_hash>{path}), std::runtime_error);
+        ASSERT_EXCEPTION(MappedUnorderedMap<int>{path + ".missing"}, std::runtime_error);
+        ASSERT_EXCEPTION(MappedUnorderedMap<int>{path}.at("other"), std::out_of_range);
+
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        ASSERT_EXCEPTION(MappedUnorderedMap<int>{path}, std::runtime_error);
+    }
+
+    // A damaged header, with the right file size, is refused rather than read past the mapping
+    {
+        UnorderedMap<std::string, int, fnv1a_hash> map(10);
+        for(int i = 0; i < 100; i++)
+            map.insert({std::to_string(i), i});
+        MappedUnorderedMap<int>::write(path, map);
+        uint64_t file_size = std::filesystem::file_size(path);
+
+        // Byte offsets in the header of size, bucket_count and the five array offsets
+        for(std::streamoff field : {16, 24, 56, 64, 72, 80, 88}) {
+            uint64_t original;
+            {
+                std::ifstream in(path, std::ios::binary);
+                in.seekg(field);
+                in.read(reinterpret_cast<char *>(&original), sizeof(original));
+            }
+            for(uint64_t damaged : {original + 1, file_size, file_size + 16, ~uint64_t{0} - 15, ~uint64_t{0}}) {
+                std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+                out.seekp(field);
+                out.write(reinterpret_cast<const char *>(&damaged), sizeof(damaged));
+                out.close();
+                ASSERT_EXCEPTION(MappedUnorderedMap<int>{path}, std::runtime_error);
+            }
+            std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+            out.seekp(field);
+            out.write(reinterpret_cast<const char *>(&original), sizeof(original));
+            out.close();
+            ASSERT_EQ(42, MappedUnorderedMap<int>{path}.at("42"));
+        }
+    }
+
+    std::filesystem::remove(path);
+}
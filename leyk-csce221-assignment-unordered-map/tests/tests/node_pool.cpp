@@ -0,0 +1,89 @@
+#include "executable.h"
+#include "node_pool.h"
+
+#include <unordered_map>
+
+TEST(node_pool) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Allocator = pool_allocator<std::pair<const int, int>>;
+        using Map = UnorderedMap<int, int, std::hash<int>, std::equal_to<int>, prime_range_hash, Allocator>;
+
+        Map map(t.range(100ull));
+        std::unordered_map<int, int> gt_map;
+        node_pool & pool = map.get_allocator().pool();
+        ASSERT_EQ(0ULL, pool.n_chunks());
+
+        // Nodes come out of chunks, not one allocation each
+        size_t n_pairs = t.range<size_t>(1, 5000);
+        {
+            Memhook mh;
+            for(size_t j = 0; j < n_pairs; j++) {
+                map.insert({static_cast<int>(j), t.get<int>()});
+            }
+            ASSERT_EQ(pool.n_chunks(), mh.n_allocs());
+            ASSERT_EQ(0ULL, mh.n_frees());
+        }
+        ASSERT_EQ(n_pairs, map.size());
+        ASSERT_EQ(n_pairs, pool.n_live());
+        ASSERT_LE(pool.n_chunks(), 2 + n_pairs / 32);
+        ASSERT_FALSE(pool.release());
+
+        for(auto const & pair : map)
+            gt_map.insert(pair);
+
+        // Erased nodes are handed out again before any new chunk
+        size_t n_erase = t.range(n_pairs);
+        for(size_t j = 0; j < n_erase; j++) {
+            int key = static_cast<int>(t.range(n_pairs));
+            ASSERT_EQ(gt_map.erase(key), map.erase(key));
+        }
+        size_t n_erased = n_pairs - map.size();
+        {
+            Memhook mh;
+            for(size_t j = 0; j < n_erased; j++) {
+                int key = static_cast<int>(n_pairs + j);
+                map.insert({key, key});
+            }
+            ASSERT_EQ(0ULL, mh.n_allocs());
+            ASSERT_EQ(0ULL, mh.n_frees());
+        }
+        for(size_t j = 0; j < n_erased; j++) {
+            int key = static_cast<int>(n_pairs + j);
+            gt_map.insert({key, key});
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+        for(auto const & [key, value] : gt_map)
+            ASSERT_EQ(value, map.find(key)->second);
+
+        // A copy gets a pool of its own, move assignment takes the source's pool
+        {
+            Map cpy_map { map };
+            ASSERT_TRUE(cpy_map.get_allocator() != map.get_allocator());
+            ASSERT_EQ(map.size(), cpy_map.size());
+        }
+
+        Map dst_map(t.range(100ull));
+        dst_map.insert({-1, -1});
+        dst_map = std::move(map);
+        ASSERT_TRUE(dst_map.get_allocator().pool().n_live() == gt_map.size());
+        ASSERT_EQ(gt_map.size(), dst_map.size());
+        for(auto const & [key, value] : gt_map)
+            ASSERT_EQ(value, dst_map.find(key)->second);
+
+        // Clearing returns every chunk at once
+        node_pool & dst_pool = dst_map.get_allocator().pool();
+        size_t n_chunks = dst_pool.n_chunks();
+        {
+            Memhook mh;
+            dst_map.clear();
+            ASSERT_EQ(n_chunks, mh.n_frees());
+        }
+        ASSERT_EQ(0ULL, dst_pool.n_chunks());
+        ASSERT_EQ(0ULL, dst_pool.n_live());
+
+        dst_map.insert({1, 1});
+        ASSERT_EQ(1ULL, dst_pool.n_chunks());
+        ASSERT_EQ(1, dst_map.find(1)->second);
+    }
+}
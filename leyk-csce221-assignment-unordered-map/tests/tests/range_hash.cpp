@@ -0,0 +1,94 @@
+#include "executable.h"
+#include "range_hash.h"
+
+#include <unordered_map>
+
+template<typename RangeHash>
+bool policy_map_matches(Typegen & t, size_t step) {
+    using Map = UnorderedMap<int, int, std::hash<int>, std::equal_to<int>, RangeHash>;
+    using value_type = std::pair<int, int>;
+
+    size_t n_pairs = t.range(1000ul);
+    std::vector<value_type> pairs(n_pairs);
+    t.fill(pairs.begin(), pairs.end());
+
+    Map map(t.range(100ull));
+    std::unordered_map<int, int> gt_map;
+    map.max_load_factor(1.0f);
+    map.rehash_step(step);
+
+    for(auto const & pair : pairs) {
+        gt_map.insert(pair);
+        map.insert(pair);
+        if(RangeHash::bucket_count(map.bucket_count()) != map.bucket_count())
+            return false;
+    }
+    if(gt_map.size() != map.size())
+        return false;
+
+    for(auto const & [key, value] : gt_map) {
+        if(map.find(key) == map.end() || map.find(key)->second != value)
+            return false;
+    }
+
+    size_t count = 0;
+    for(size_t bucket = 0; bucket < map.bucket_count(); bucket++) {
+        for(auto it = map.begin(bucket); it != map.end(bucket); it++) {
+            if(map.bucket(it->first) != bucket)
+                return false;
+            count++;
+        }
+    }
+    if(count != map.size())
+        return false;
+
+    for(auto const & pair : pairs) {
+        if(gt_map.erase(pair.first) != map.erase(pair.first))
+            return false;
+    }
+    return map.empty();
+}
+
+TEST(range_hash) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        size_t count = t.range(1ull << 40);
+
+        // fastmod computes exactly the same buckets as the modulo
+        size_t prime = fastmod_range_hash::bucket_count(count);
+        ASSERT_EQ(prime_range_hash::bucket_count(count), prime);
+        prime_range_hash modulo(prime);
+        fastmod_range_hash fastmod(prime);
+        for(size_t j = 0; j < 1000; j++) {
+            size_t code = t.get<size_t>();
+            ASSERT_EQ(modulo(code), fastmod(code));
+        }
+        ASSERT_EQ(modulo(~size_t{0}), fastmod(~size_t{0}));
+        ASSERT_EQ(0ULL, fastmod_range_hash(1)(t.get<size_t>()));
+
+        // power of two bucket counts
+        size_t power = pow2_range_hash::bucket_count(count);
+        ASSERT_GE(power, count);
+        ASSERT_LT(power / 2, count);
+        ASSERT_EQ(0ULL, power & (power - 1));
+
+        pow2_range_hash pow2(power);
+        for(size_t j = 0; j < 1000; j++)
+            ASSERT_LT(pow2(t.get<size_t>()), power);
+
+        // consecutive codes still spread over the buckets
+        pow2_range_hash small(64);
+        std::vector<size_t> bucket_sizes(64);
+        for(size_t code = 0; code < 64 * 64; code++)
+            bucket_sizes[small(code)]++;
+        for(size_t bucket_size : bucket_sizes)
+            ASSERT_LT(bucket_size, 2 * 64ULL);
+
+        // maps behave the same under every policy, growing at once or incrementally
+        for(size_t step = 0; step < 2; step++) {
+            ASSERT_TRUE(policy_map_matches<prime_range_hash>(t, step));
+            ASSERT_TRUE(policy_map_matches<fastmod_range_hash>(t, step));
+            ASSERT_TRUE(policy_map_matches<pow2_range_hash>(t, step));
+        }
+    }
+}
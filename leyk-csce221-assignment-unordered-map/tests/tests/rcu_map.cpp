@@ -0,0 +1,146 @@
+#include "executable.h"
+#include "RcuUnorderedMap.h"
+
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+/* A value which counts how many of its kind are alive */
+struct live_value {
+    static std::atomic<long> n_live;
+
+    int value;
+
+    live_value(int value = 0) : value(value) { n_live++; }
+
+    live_value(live_value const & other) : value(other.value) { n_live++; }
+
+    ~live_value() { n_live--; }
+};
+
+std::atomic<long> live_value::n_live{0};
+
+TEST(rcu_map) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = RcuUnorderedMap<int, live_value>;
+        using value_type = std::pair<int, int>;
+
+        {
+            Map map(t.range(100ull));
+            std::unordered_map<int, int> gt_map;
+
+            size_t n_pairs = t.range(2000ul);
+            std::vector<value_type> pairs(n_pairs);
+            t.fill(pairs.begin(), pairs.end());
+            for(auto const & [key, value] : pairs)
+                ASSERT_EQ(gt_map.insert({key, value}).second, map.insert({key, value}));
+            ASSERT_EQ(gt_map.size(), map.size());
+            ASSERT_LE(map.size(), map.bucket_count());
+
+            for(auto const & [key, value] : gt_map) {
+                ASSERT_EQ(value, map.find(key)->value);
+                ASSERT_TRUE(map.contains(key));
+            }
+
+            for(size_t j = 0; j < 200; j++) {
+                int key = t.range(2) || pairs.empty() ? t.get<int>() : pairs[t.range(n_pairs)].first;
+                if(t.range(2)) {
+                    ASSERT_EQ(gt_map.erase(key), map.erase(key));
+                } else {
+                    int value = t.get<int>();
+                    bool inserted = gt_map.count(key) == 0;
+                    gt_map[key] = value;
+                    ASSERT_EQ(inserted, map.insert_or_assign(key, live_value(value)));
+                }
+            }
+            ASSERT_EQ(gt_map.size(), map.size());
+
+            size_t count = 0;
+            map.for_each([&](int const & key, live_value const & value) {
+                if(gt_map.at(key) == value.value)
+                    count++;
+            });
+            ASSERT_EQ(gt_map.size(), count);
+
+            // Once synchronized, only the map's own values are alive
+            map.synchronize();
+            ASSERT_EQ(0ULL, map.retired());
+            ASSERT_EQ(static_cast<long>(map.size()), live_value::n_live.load());
+
+            map.clear();
+            ASSERT_TRUE(map.empty());
+            ASSERT_FALSE(map.contains(pairs.empty() ? 0 : pairs[0].first));
+            map.synchronize();
+            ASSERT_EQ(0L, live_value::n_live.load());
+
+            map.insert({1, 1});
+        }
+        ASSERT_EQ(0L, live_value::n_live.load());
+    }
+
+    // Readers always see the stable keys with their values while a writer churns the rest
+    {
+        using Map = RcuUnorderedMap<int, live_value>;
+
+        constexpr int N_READERS = 4;
+        constexpr int N_STABLE = 500;
+        constexpr int N_WRITES = 20000;
+
+        Map map(0);
+        for(int key = 0; key < N_STABLE; key++)
+            map.insert({key, live_value(key)});
+
+        std::atomic<bool> done{false};
+        std::atomic<size_t> errors{0};
+        std::vector<std::thread> readers;
+        for(int reader = 0; reader < N_READERS; reader++) {
+            readers.emplace_back([&map, &done, &errors] {
+                while(!done.load()) {
+                    for(int key = 0; key < N_STABLE; key++) {
+                        std::optional<live_value> value = map.find(key);
+                        if(!value || value->value != key)
+                            errors++;
+                        // Churned keys hold their own key or are missing
+                        map.visit(-1 - key, [&](live_value const & v) {
+                            if(v.value != -1 - key)
+                                errors++;
+                        });
+                    }
+                    // Read without the writer lock while the writer changes it
+                    float ml = map.max_load_factor();
+                    if(ml != 1.0f && ml != 2.0f)
+                        errors++;
+                }
+            });
+        }
+
+        for(int j = 0; j < N_WRITES; j++) {
+            int key = -1 - static_cast<int>(t.range(5000));
+            switch(t.range(3)) {
+                case 0: map.insert({key, live_value(key)}); break;
+                case 1: map.insert_or_assign(key, live_value(key)); break;
+                default: map.erase(key); break;
+            }
+            // Replacing a stable key's node never hides it from readers
+            int stable = static_cast<int>(t.range(N_STABLE));
+            map.insert_or_assign(stable, live_value(stable));
+            if(j % 100 == 0)
+                map.max_load_factor(j % 200 == 0 ? 2.0f : 1.0f);
+        }
+        done = true;
+        for(auto & reader : readers)
+            reader.join();
+        ASSERT_EQ(0ULL, errors.load());
+    }
+}
+
+TEST(rcu_map_max_load_factor_invalid) {
+    RcuUnorderedMap<int, int> map(16);
+    ASSERT_EXCEPTION(map.max_load_factor(0.0f), std::invalid_argument);
+    ASSERT_EXCEPTION(map.max_load_factor(-1.0f), std::invalid_argument);
+    ASSERT_EXCEPTION(map.max_load_factor(std::numeric_limits<float>::quiet_NaN()), std::invalid_argument);
+    ASSERT_EQ(1.0f, map.max_load_factor());
+}
@@ -0,0 +1,100 @@
+#include "executable.h"
+#include "map_logic.h"
+
+#include <cmath>
+#include <unordered_map>
+
+template<typename Map>
+bool all_in_correct_buckets(Map & map) {
+    size_t count = 0;
+    for(size_t bucket = 0; bucket < map.bucket_count(); bucket++) {
+        for(auto it = map.begin(bucket); it != map.end(bucket); it++) {
+            if(correct_bucket<Map>(it->first, map.bucket_count()) != bucket)
+                return false;
+            count++;
+        }
+    }
+    return count == map.size();
+}
+
+TEST(rehash) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = UnorderedMap<double, double>;
+        using value_type = std::pair<double, double>;
+
+        size_t n_pairs = t.range(1000ul);
+        std::vector<value_type> pairs(n_pairs);
+        t.fill(pairs.begin(), pairs.end());
+
+        size_t n = t.range(100ull);
+
+        // Growth is off by default
+        {
+            Map map(n);
+            ASSERT_TRUE(std::isinf(map.max_load_factor()));
+            for(auto const & pair : pairs)
+                map.insert(pair);
+            ASSERT_EQ(next_greater_prime(n), map.bucket_count());
+        }
+
+        // Automatic growth keeps the load factor bounded
+        {
+            Map map(n);
+            std::unordered_map<double, double> gt_map;
+            float ml = t.range<float>(0.5f, 2.0f);
+            map.max_load_factor(ml);
+
+            for(auto const & pair : pairs) {
+                gt_map.insert(pair);
+                map.insert(pair);
+                ASSERT_LE(map.load_factor(), ml);
+                ASSERT_EQ(next_greater_prime(map.bucket_count()), map.bucket_count());
+            }
+            ASSERT_EQ(gt_map.size(), map.size());
+            ASSERT_TRUE(all_in_correct_buckets(map));
+
+            for(auto const & [key, value] : gt_map)
+                ASSERT_EQ(value, map.find(key)->second);
+        }
+
+        // rehash relinks nodes without reallocating them
+        {
+            Map map(n);
+            for(auto const & pair : pairs)
+                map.insert(pair);
+
+            std::vector<typename Map::const_pointer> addresses;
+            for(auto it = map.begin(); it != map.end(); it++)
+                addresses.push_back(&(*it));
+
+            size_t count = t.range(2000ull);
+            {
+                Memhook mh;
+                map.rehash(count);
+                ASSERT_LE(mh.n_allocs(), 1ULL);
+                ASSERT_EQ(mh.n_allocs(), mh.n_frees());
+            }
+            ASSERT_EQ(next_greater_prime(count), map.bucket_count());
+            ASSERT_TRUE(all_in_correct_buckets(map));
+
+            for(typename Map::const_pointer address : addresses)
+                ASSERT_EQ(address, &(*map.find(address->first)));
+        }
+
+        // reserve pre-sizes so later inserts only allocate nodes
+        {
+            Map map(0);
+            map.max_load_factor(1.0f);
+            map.reserve(n_pairs);
+            size_t bucket_count = map.bucket_count();
+            ASSERT_GE(bucket_count, n_pairs);
+
+            Memhook mh;
+            for(auto const & pair : pairs)
+                map.insert(pair);
+            ASSERT_EQ(map.size(), mh.n_allocs());
+            ASSERT_EQ(bucket_count, map.bucket_count());
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#include "executable.h"
+
+#include <bitset>
+#include <unordered_map>
+
+/* sip_hash whose first key sends every string to 0, like keys chosen by an attacker. Counts its reseeds. */
+struct flooded_hash {
+    sip_hash hash;
+    size_t * reseeds;
+
+    flooded_hash(size_t * reseeds = nullptr) : reseeds(reseeds) {}
+
+    size_t operator()(std::string const & str) const {
+        return *reseeds == 0 ? 0 : hash(str);
+    }
+
+    void reseed() {
+        hash.reseed();
+        (*reseeds)++;
+    }
+};
+
+TEST(seeded_hash) {
+    Typegen t;
+
+    static_assert(_unordered_map_reseedable<sip_hash>::value);
+    static_assert(!_unordered_map_reseedable<fnv1a_hash>::value);
+
+    // Keyed: the same key always gives the same hash, other keys give others
+    {
+        sip_hash fixed(1, 2);
+        std::string str = t.get<std::string>();
+        ASSERT_EQ(fixed(str), sip_hash(1, 2)(str));
+        ASSERT_EQ(fixed(str), fixed(std::string_view(str)));
+        ASSERT_EQ(fixed(str), fixed(str.c_str()));
+        ASSERT_NE(fixed(str), sip_hash(1, 3)(str));
+        ASSERT_NE(fixed(str), sip_hash(2, 2)(str));
+
+        sip_hash random;
+        size_t before = random(str);
+        ASSERT_NE(before, sip_hash()(str));
+        random.reseed();
+        ASSERT_NE(before, random(str));
+    }
+
+    // Every input bit reaches about half of the output bits
+    for(size_t len : {0ull, 1ull, 7ull, 8ull, 9ull, 31ull, 100ull}) {
+        sip_hash hash;
+        size_t n_flipped = 0;
+        size_t n_trials = 0;
+        for(size_t i = 0; len > 0 && i < TEST_ITER; i++) {
+            std::string key = t.get<std::string>(len);
+            size_t original = hash(key);
+            size_t bit = t.range(8 * len);
+            key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+            n_flipped += std::bitset<64>(original ^ hash(key)).count();
+            n_trials++;
+        }
+        if(n_trials > 0) {
+            double mean = static_cast<double>(n_flipped) / n_trials;
+            ASSERT_GT(mean, 28.0);
+            ASSERT_LT(mean, 36.0);
+        }
+    }
+
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = UnorderedMap<std::string, int, flooded_hash>;
+
+        // A flooded bucket gets the hasher reseeded and the map rehashed
+        size_t reseeds = 0;
+        size_t max_chain = t.range<size_t>(2, 16);
+        Map map(t.range<size_t>(100, 1000), flooded_hash(&reseeds));
+        map.max_chain_length(max_chain);
+        ASSERT_EQ(max_chain, map.max_chain_length());
+
+        std::unordered_map<std::string, int> gt_map;
+        size_t n_pairs = t.range<size_t>(max_chain + 1, 2000);
+        std::string first_key;
+        int * first_value = nullptr;
+        for(size_t j = 0; j < n_pairs; j++) {
+            std::string key = std::to_string(j) + t.get<std::string>(t.range(8ull));
+            int value = t.get<int>();
+            if(map.insert({key, value}).second) {
+                gt_map.insert({key, value});
+                if(first_value == nullptr) {
+                    first_key = key;
+                    first_value = &map.find(key)->second;
+                }
+            }
+        }
+        ASSERT_GE(reseeds, 1ULL);
+        ASSERT_LE(reseeds, 2 + static_cast<size_t>(std::log2(n_pairs)));
+        ASSERT_EQ(gt_map.size(), map.size());
+        for(auto const & [key, value] : gt_map)
+            ASSERT_EQ(value, map.find(key)->second);
+
+        // Nodes are relinked, not reallocated
+        ASSERT_TRUE(first_value == &map.find(first_key)->second);
+
+        // Only keys sent to one bucket were long; afterwards the buckets are at the map's load factor
+        size_t longest = 0;
+        for(size_t bucket = 0; bucket < map.bucket_count(); bucket++)
+            longest = std::max(longest, map.bucket_size(bucket));
+        ASSERT_LT(longest, 4 + 4 * static_cast<size_t>(map.load_factor()) + max_chain);
+
+        // The hasher in the map is the reseeded one
+        ASSERT_NE(0ULL, map.hash_function()(first_key));
+    }
+
+    // A full map with long chains everywhere is reseeded once per doubling, not on every insert
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        size_t reseeds = 1;
+        UnorderedMap<std::string, int, flooded_hash> map(t.range<size_t>(1, 20), flooded_hash(&reseeds));
+        map.max_chain_length(2);
+        size_t n_pairs = t.range<size_t>(1, 5000);
+        for(size_t j = 0; j < n_pairs; j++)
+            map.insert({std::to_string(j), 0});
+        ASSERT_LE(reseeds - 1, 2 + static_cast<size_t>(std::log2(n_pairs)));
+        for(size_t j = 0; j < n_pairs; j++)
+            ASSERT_TRUE(map.contains(std::to_string(j)));
+    }
+
+    // Bulk inserts are checked too
+    {
+        size_t reseeds = 0;
+        std::vector<std::pair<std::string, int>> pairs;
+        for(int j = 0; j < 100; j++)
+            pairs.push_back({std::to_string(j), j});
+        UnorderedMap<std::string, int, flooded_hash> map(100, flooded_hash(&reseeds));
+        map.max_chain_length(8);
+        map.insert(pairs.begin(), pairs.end());
+        ASSERT_EQ(1ULL, reseeds);
+        for(auto const & [key, value] : pairs)
+            ASSERT_EQ(value, map.find(key)->second);
+    }
+}
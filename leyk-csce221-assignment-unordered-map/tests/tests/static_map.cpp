@@ -0,0 +1,77 @@
+#include "executable.h"
+#include "StaticUnorderedMap.h"
+
+#include <unordered_map>
+
+constexpr auto STATIC_COLORS = make_static_string_map<int>({
+    {"red", 0xFF0000}, {"green", 0x00FF00}, {"blue", 0x0000FF}, {"black", 0x000000}, {"white", 0xFFFFFF}
+});
+static_assert(*STATIC_COLORS.find("green") == 0x00FF00);
+static_assert(*STATIC_COLORS.find("black") == 0x000000);
+static_assert(!STATIC_COLORS.contains("yellow"));
+static_assert(STATIC_COLORS.size() == 5);
+
+TEST(static_map) {
+    Typegen t;
+
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        std::unordered_map<std::string, int> gt_map;
+        size_t n_pairs = t.range(5000ull);
+        for(size_t j = 0; j < n_pairs; j++)
+            gt_map.insert({t.get<std::string>(t.range(20ull)), t.get<int>()});
+
+        StaticUnorderedMap<std::string, int> map(gt_map.begin(), gt_map.end());
+        ASSERT_EQ(gt_map.size(), map.size());
+        ASSERT_EQ(gt_map.empty(), map.empty());
+        if(gt_map.size() >= 1000)
+            ASSERT_LE(map.bits_per_key(), 4.0);
+
+        for(auto const & [key, value] : gt_map) {
+            auto it = map.find(key);
+            ASSERT_TRUE(it != map.end());
+            ASSERT_TRUE(key == it->first);
+            ASSERT_EQ(value, it->second);
+            ASSERT_EQ(value, map.at(key));
+            ASSERT_EQ(1ULL, map.count(key));
+        }
+
+        // Keys are 20 characters at most, so these are all misses
+        for(size_t j = 0; j < 100; j++) {
+            std::string key = t.get<std::string>(21);
+            ASSERT_FALSE(map.contains(key));
+            ASSERT_TRUE(map.find(key) == map.end());
+            ASSERT_EXCEPTION(map.at(key), std::out_of_range);
+        }
+
+        // Iteration visits every element once
+        size_t count = 0;
+        for(auto const & [key, value] : map) {
+            ASSERT_EQ(gt_map.at(key), value);
+            count++;
+        }
+        ASSERT_EQ(gt_map.size(), count);
+
+        // Values can be changed in place
+        for(auto & [key, value] : map)
+            value = static_cast<int>(key.size());
+        for(auto const & [key, value] : gt_map)
+            ASSERT_EQ(static_cast<int>(key.size()), map.at(key));
+    }
+
+    {
+        StaticUnorderedMap<int, std::string> map({{1, "one"}, {2, "two"}, {3, "three"}});
+        ASSERT_TRUE(map.at(2) == "two");
+        ASSERT_FALSE(map.contains(4));
+
+        StaticUnorderedMap<int, int> empty({});
+        ASSERT_TRUE(empty.empty());
+        ASSERT_FALSE(empty.contains(0));
+        ASSERT_TRUE(empty.begin() == empty.end());
+
+        // Equal keys have no perfect hash
+        ASSERT_EXCEPTION((StaticUnorderedMap<int, int>{{1, 1}, {1, 2}}), std::invalid_argument);
+    }
+
+    for(auto const & [key, value] : STATIC_COLORS)
+        ASSERT_EQ(value, *STATIC_COLORS.find(key));
+}
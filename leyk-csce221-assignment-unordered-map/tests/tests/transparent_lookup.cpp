@@ -0,0 +1,78 @@
+#include "executable.h"
+
+#include <string_view>
+#include <unordered_map>
+
+TEST(transparent_lookup) {
+    Typegen t;
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        using Map = UnorderedMap<std::string, int, fnv1a_hash, std::equal_to<>>;
+
+        Map map(t.range(100ull));
+        std::unordered_map<std::string, int> gt_map;
+
+        size_t n_pairs = t.range(1000ull);
+        for(size_t j = 0; j < n_pairs; j++) {
+            // Long enough that every key is allocated on the heap
+            std::string key = "transparent-lookup-key-" + t.get<std::string>();
+            int value = t.get<int>();
+            gt_map.insert({key, value});
+            map.insert({key, value});
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+
+        std::vector<std::string> missing;
+        for(size_t j = 0; j < 100; j++) {
+            std::string key = "missing-transparent-lookup-key-" + t.get<std::string>();
+            if(gt_map.count(key) == 0)
+                missing.push_back(key);
+        }
+
+        // Lookups by string_view and C string build no std::string
+        Map const & cmap = map;
+        {
+            Memhook mh;
+            for(auto const & [key, value] : gt_map) {
+                std::string_view view = key;
+                ASSERT_EQ(value, map.find(view)->second);
+                ASSERT_EQ(value, cmap.find(view)->second);
+                ASSERT_EQ(value, map.find(key.c_str())->second);
+                ASSERT_TRUE(map.contains(view));
+                ASSERT_EQ(1ULL, map.count(key.c_str()));
+            }
+            for(auto const & key : missing) {
+                std::string_view view = key;
+                ASSERT_TRUE(map.find(view) == map.end());
+                ASSERT_FALSE(map.contains(key.c_str()));
+                ASSERT_EQ(0ULL, map.count(view));
+                ASSERT_EQ(0ULL, map.erase(view));
+            }
+            ASSERT_EQ(0ULL, mh.n_allocs());
+            ASSERT_EQ(0ULL, mh.n_frees());
+        }
+
+        // Erasing by string_view frees the node and its key, nothing else
+        std::vector<std::string> erased;
+        for(auto const & [key, value] : gt_map) {
+            if(t.range(2) == 0)
+                erased.push_back(key);
+        }
+        {
+            Memhook mh;
+            for(auto const & key : erased)
+                ASSERT_EQ(1ULL, map.erase(std::string_view(key)));
+            ASSERT_EQ(0ULL, mh.n_allocs());
+            ASSERT_EQ(2 * erased.size(), mh.n_frees());
+        }
+        for(auto const & key : erased)
+            gt_map.erase(key);
+
+        ASSERT_EQ(gt_map.size(), map.size());
+        for(auto const & [key, value] : gt_map)
+            ASSERT_EQ(value, map.find(key)->second);
+
+        // Erasing through an iterator still works with a transparent map
+        while(!map.empty())
+            map.erase(map.begin());
+    }
+}
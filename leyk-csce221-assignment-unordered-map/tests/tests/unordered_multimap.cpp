@@ -0,0 +1,123 @@
+#include "executable.h"
+#include "UnorderedMultiMap.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+// The values of key in equal_range order, or nothing if the range holds another key
+template<typename Map>
+std::vector<int> ordered_values_of(Map & map, int key) {
+    std::vector<int> values;
+    auto [first, last] = map.equal_range(key);
+    for(auto it = first; it != last; ++it) {
+        if(it->first != key)
+            return {};
+        values.push_back(it->second);
+    }
+    return values;
+}
+
+template<typename Map>
+std::vector<int> values_of(Map & map, int key) {
+    std::vector<int> values = ordered_values_of(map, key);
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+TEST(unordered_multimap) {
+    Typegen t;
+
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        UnorderedMultiMap<int, int> map(t.range(100ull));
+        std::unordered_multimap<int, int> gt_map;
+        if(t.range(2)) {
+            map.max_load_factor(1.0f);
+            map.rehash_step(t.range(4ull));
+        }
+
+        // Few distinct keys, so most of them repeat
+        size_t n_pairs = t.range(2000ull);
+        int n_keys = 1 + t.range(100);
+        for(size_t j = 0; j < n_pairs; j++) {
+            int key = t.range(n_keys);
+            int value = t.get<int>();
+            gt_map.insert({key, value});
+            auto it = j % 2 ? map.insert({key, value}) : map.emplace(key, value);
+            ASSERT_EQ(key, it->first);
+            ASSERT_EQ(value, it->second);
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+
+        // equal_range is one contiguous run holding exactly the key's values
+        for(int key = 0; key < n_keys; key++) {
+            ASSERT_EQ(gt_map.count(key), map.count(key));
+            ASSERT_TRUE(values_of(gt_map, key) == values_of(map, key));
+            if(gt_map.count(key) > 0)
+                ASSERT_EQ(key, map.find(key)->first);
+        }
+
+        size_t count = 0;
+        for(auto it = map.begin(); it != map.end(); ++it)
+            count++;
+        ASSERT_EQ(gt_map.size(), count);
+
+        // A range keeps every element
+        UnorderedMultiMap<int, int> copy(gt_map.begin(), gt_map.end());
+        ASSERT_EQ(gt_map.size(), copy.size());
+        for(int key = 0; key < n_keys; key++)
+            ASSERT_TRUE(values_of(gt_map, key) == values_of(copy, key));
+
+        // Erasing a key erases all of its elements; extract takes one
+        for(int key = 0; key < n_keys; key++) {
+            if(t.range(2)) {
+                ASSERT_EQ(gt_map.erase(key), map.erase(key));
+                ASSERT_FALSE(map.contains(key));
+            } else if(gt_map.count(key) > 0) {
+                auto nh = map.extract(key);
+                ASSERT_EQ(key, nh.key());
+                auto [first, last] = gt_map.equal_range(key);
+                gt_map.erase(std::find(first, last, std::pair<const int, int>(key, nh.mapped())));
+                ASSERT_EQ(gt_map.count(key), map.count(key));
+                nh.mapped() = -1;
+                ASSERT_EQ(-1, map.insert(std::move(nh))->second);
+                gt_map.insert({key, -1});
+            }
+        }
+        ASSERT_EQ(gt_map.size(), map.size());
+        for(int key = 0; key < n_keys; key++)
+            ASSERT_TRUE(values_of(gt_map, key) == values_of(map, key));
+    }
+}
+
+TEST(unordered_multimap_rehash_order) {
+    Typegen t;
+
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        UnorderedMultiMap<int, int> map(t.range(100ull));
+        map.max_load_factor(1.0f);
+        size_t step = t.range(4ull);
+        map.rehash_step(step);
+
+        size_t n_pairs = t.range(2000ull);
+        int n_keys = 1 + t.range(100);
+        std::vector<std::vector<int>> before(n_keys);
+        for(size_t j = 0; j < n_pairs; j++) {
+            int key = t.range(n_keys);
+            map.insert({key, static_cast<int>(j)});
+
+            // The new value goes first; growing, or a migration moving more buckets, keeps every key's order
+            before[key].insert(before[key].begin(), static_cast<int>(j));
+            for(int k = 0; k < n_keys; k++)
+                ASSERT_TRUE(before[k] == ordered_values_of(map, k));
+        }
+
+        // rehash() to larger and smaller bucket counts relinks everything and keeps the order too
+        for(int k = 0; k < n_keys; k++)
+            before[k] = ordered_values_of(map, k);
+        for(size_t count : {map.bucket_count() * 3 + 1, map.bucket_count() / 2 + 1, t.range<size_t>(1, 500)}) {
+            map.rehash(count);
+            for(int k = 0; k < n_keys; k++)
+                ASSERT_TRUE(before[k] == ordered_values_of(map, k));
+        }
+    }
+}
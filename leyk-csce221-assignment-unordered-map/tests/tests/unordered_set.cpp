@@ -0,0 +1,77 @@
+#include "executable.h"
+#include "UnorderedSet.h"
+
+#include <unordered_set>
+
+TEST(unordered_set) {
+    Typegen t;
+
+    for(size_t i = 0; i < TEST_ITER; i++) {
+        UnorderedSet<int> set(t.range(100ull));
+        std::unordered_set<int> gt_set;
+        if(t.range(2)) {
+            set.max_load_factor(1.0f);
+            set.rehash_step(t.range(4ull));
+        }
+
+        size_t n_keys = t.range(2000ull);
+        for(size_t j = 0; j < n_keys; j++) {
+            int key = t.range(1000);
+            bool inserted = gt_set.insert(key).second;
+            auto [it, set_inserted] = j % 2 ? set.insert(key) : set.emplace(key);
+            ASSERT_EQ(inserted, set_inserted);
+            ASSERT_EQ(key, *it);
+        }
+        ASSERT_EQ(gt_set.size(), set.size());
+
+        for(int key = 0; key < 1000; key++) {
+            ASSERT_EQ(gt_set.count(key), set.count(key));
+            ASSERT_EQ(gt_set.count(key) == 1, set.contains(key));
+        }
+
+        // Every key is visited once
+        size_t count = 0;
+        for(auto it = set.begin(); it != set.end(); ++it) {
+            ASSERT_EQ(1ULL, gt_set.count(*it));
+            count++;
+        }
+        ASSERT_EQ(gt_set.size(), count);
+
+        // A key can change while its node is out of the set
+        if(!gt_set.empty()) {
+            int key = *set.begin();
+            auto nh = set.extract(key);
+            ASSERT_EQ(key, nh.value());
+            nh.value() = 1000 + key;
+            ASSERT_TRUE(set.insert(std::move(nh)).inserted);
+            ASSERT_FALSE(set.contains(key));
+            ASSERT_TRUE(set.contains(1000 + key));
+            gt_set.erase(key);
+            gt_set.insert(1000 + key);
+        }
+
+        for(int key = 0; key < 1000; key++) {
+            if(t.range(2)) {
+                ASSERT_EQ(gt_set.erase(key), set.erase(key));
+            }
+        }
+        ASSERT_EQ(gt_set.size(), set.size());
+        for(int key : gt_set)
+            ASSERT_TRUE(set.contains(key));
+
+        UnorderedSet<int> copy(set);
+        ASSERT_EQ(set.size(), copy.size());
+        for(int key : gt_set)
+            ASSERT_TRUE(copy.contains(key));
+    }
+
+    // Range construction keeps the first of equal keys, and string sets take string_views when transparent
+    {
+        std::vector<std::string> words = {"red", "green", "red", "blue", "green"};
+        UnorderedSet<std::string, fnv1a_hash, std::equal_to<>> set(words.begin(), words.end());
+        ASSERT_EQ(3ULL, set.size());
+        ASSERT_TRUE(set.contains(std::string_view("blue")));
+        ASSERT_EQ(1ULL, set.erase(std::string_view("red")));
+        ASSERT_FALSE(set.contains("red"));
+    }
+}
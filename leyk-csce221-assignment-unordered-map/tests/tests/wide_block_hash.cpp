@@ -0,0 +1,68 @@
+#include "executable.h"
+
+#include <bitset>
+#include <string_view>
+
+/* The load variance main.cpp reports: about 1 when keys spread like uniform random ones */
+template<typename Hash>
+double load_variance(std::vector<std::string> const & keys) {
+    UnorderedMap<std::string, int, Hash> map(30);
+    for(auto const & key : keys)
+        map.insert({key, 0});
+
+    double variance = 0;
+    for(size_t bucket = 0; bucket < map.bucket_count(); bucket++) {
+        double res = map.bucket_size(bucket) - map.load_factor();
+        variance += res * res;
+    }
+    return variance / (map.size() - 1);
+}
+
+TEST(wide_block_hash) {
+    using isa = wide_block_hash::isa;
+    Typegen t;
+    wide_block_hash hash;
+
+    ASSERT_TRUE(wide_block_hash::supported(isa::scalar));
+    ASSERT_TRUE(wide_block_hash::supported(wide_block_hash::best()));
+
+    // Every path gives the same hash at every length and alignment
+    std::string buffer = t.get<std::string>(1024);
+    for(size_t len = 0; len <= 600; len++) {
+        for(size_t offset = 0; offset < 8; offset++) {
+            std::string_view str(buffer.data() + offset, len);
+            size_t expected = wide_block_hash::hash(str, isa::scalar);
+            ASSERT_EQ(expected, hash(str));
+            ASSERT_EQ(expected, hash(std::string(str)));
+            for(isa path : {isa::sse2, isa::avx2})
+                if(wide_block_hash::supported(path))
+                    ASSERT_EQ(expected, wide_block_hash::hash(str, path));
+        }
+    }
+
+    // Keys which differ only in a few characters spread evenly, short or long
+    for(size_t prefix_len : {0ull, 8ull, 40ull, 300ull}) {
+        std::string prefix = "https://example.com/" + t.get<std::string>(prefix_len) + "/";
+        std::vector<std::string> keys;
+        for(size_t i = 0; i < 10000; i++)
+            keys.push_back(prefix + std::to_string(i));
+        ASSERT_LT(load_variance<wide_block_hash>(keys), 1.5);
+    }
+
+    // Flipping one input bit flips about half of the output bits
+    for(size_t len : {1ull, 3ull, 7ull, 12ull, 24ull, 33ull, 64ull, 257ull, 1000ull}) {
+        size_t n_flipped = 0;
+        size_t n_trials = 0;
+        for(size_t i = 0; i < TEST_ITER; i++) {
+            std::string key = t.get<std::string>(len);
+            size_t original = hash(key);
+            size_t bit = t.range(8 * len);
+            key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+            n_flipped += std::bitset<64>(original ^ hash(key)).count();
+            n_trials++;
+        }
+        double mean = static_cast<double>(n_flipped) / n_trials;
+        ASSERT_GT(mean, 28.0);
+        ASSERT_LT(mean, 36.0);
+    }
+}